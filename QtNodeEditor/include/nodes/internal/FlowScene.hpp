@@ -4,6 +4,7 @@
 #include <QtWidgets/QGraphicsScene>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <tuple>
 #include <functional>
 
@@ -23,6 +24,7 @@ class NodeGraphicsObject;
 class Connection;
 class ConnectionGraphicsObject;
 class NodeStyle;
+class ConnectionStyle;
 
 /// Scene holds connections and nodes.
 class NODE_EDITOR_PUBLIC FlowScene
@@ -77,6 +79,23 @@ public:
   void setNodePosition(Node& node, const QPointF& pos) const;
 
   QSizeF getNodeSize(const Node& node) const;
+
+public:
+
+  /// Style changes made between beginStyleUpdate() and endStyleUpdate() are
+  /// applied as one: each item, and its cached pixmap, is invalidated once
+  /// at the end, and the views repaint once. The calls can be nested.
+  void beginStyleUpdate();
+
+  void endStyleUpdate();
+
+  /// Styles are shared, not copied. Setting the style an item already has
+  /// does not invalidate it.
+  void setNodeStyle(Node& node, std::shared_ptr<NodeStyle const> style);
+
+  void setConnectionStyle(Connection& connection,
+                          std::shared_ptr<ConnectionStyle const> style);
+
 public:
 
   std::unordered_map<QUuid, std::unique_ptr<Node> > const &nodes() const;
@@ -138,6 +157,11 @@ private:
 
   QtNodes::PortLayout _layout;
 
+  // ids, not pointers: an item can be deleted during an update
+  int _styleUpdateDepth = 0;
+  std::unordered_set<QUuid> _styleDirtyNodes;
+  std::unordered_set<QUuid> _styleDirtyConnections;
+
 };
 
 Node*
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QtGui/QPainter>
+#include <QtWidgets/QStyleOptionGraphicsItem>
+
+namespace QtNodes
+{
+
+/// How much of the nodes and connections is painted, from the scale of the
+/// view: what can't be read when zoomed out is not painted at all.
+enum class LevelOfDetail
+{
+  Full,       ///< widgets, ports, icons and shadows
+  Simplified, ///< boxes with their caption
+  Minimal     ///< colored boxes and straight connections
+};
+
+inline
+LevelOfDetail
+levelOfDetail(QTransform const& transform)
+{
+  double const scale =
+    QStyleOptionGraphicsItem::levelOfDetailFromTransform(transform);
+
+  if (scale < 0.2)
+    return LevelOfDetail::Minimal;
+
+  if (scale < 0.5)
+    return LevelOfDetail::Simplified;
+
+  return LevelOfDetail::Full;
+}
+
+inline
+LevelOfDetail
+levelOfDetail(QPainter const* painter)
+{
+  return levelOfDetail(painter->worldTransform());
+}
+}
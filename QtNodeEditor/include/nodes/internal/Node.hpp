@@ -101,6 +101,10 @@ public slots: // data propagation
   void
   onNodeSizeUpdated();
 
+  /// embed the widget created by the model after the node
+  void
+  onEmbeddedWidgetChanged();
+
 private:
 
   // addressing
@@ -40,6 +40,10 @@ public:
   virtual QString
   name() const = 0;
 
+  /// Drawn in place of the content when the view is zoomed out
+  virtual QString
+  caption() const { return name(); }
+
 public:
 
   QJsonObject
@@ -74,6 +78,10 @@ public:
   void
   setNodeStyle(NodeStyle const& style);
 
+  /// The style is shared, not copied: it must not change afterwards.
+  void
+  setNodeStyle(std::shared_ptr<NodeStyle const> style);
+
 public:
 
   /// Triggers the algorithm
@@ -90,6 +98,25 @@ public:
   QWidget *
   embeddedWidget() = 0;
 
+  /// Size of the content drawn by the painterDelegate() in place of the
+  /// embedded widget, while there is none.
+  virtual
+  QSize
+  paintedContentSize() const { return QSize(); }
+
+  /// The user is about to interact with the node: a model that paints its
+  /// content can create its embedded widget now, and emit
+  /// embeddedWidgetChanged().
+  virtual
+  void
+  requestEmbeddedWidget() {}
+
+  /// A mouse press on the painted content, at pos relative to its top left
+  /// corner. Called even if the node is locked; returns true if handled.
+  virtual
+  bool
+  paintedContentPressed(QPointF const& pos) { Q_UNUSED(pos); return false; }
+
   virtual
   bool
   resizable() const { return false; }
@@ -121,8 +148,10 @@ signals:
 
   void embeddedWidgetSizeUpdated();
 
+  void embeddedWidgetChanged();
+
 private:
 
-  NodeStyle _nodeStyle;
+  std::shared_ptr<NodeStyle const> _nodeStyle;
 };
 }
@@ -2,6 +2,7 @@
 
 #include <QtCore/QRectF>
 #include <QtCore/QPointF>
+#include <QtCore/QSize>
 #include <QtGui/QTransform>
 #include <QtGui/QFontMetrics>
 
@@ -126,6 +127,10 @@ private:
   unsigned int
   portWidth(PortType portType) const;
 
+  /// The embedded widget, or what the model paints in its place.
+  QSize
+  contentSize() const;
+
 private:
 
   // some variables are mutable because
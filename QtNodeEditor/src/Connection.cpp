@@ -29,13 +29,14 @@ using QtNodes::NodeDataType;
 using QtNodes::ConnectionGraphicsObject;
 using QtNodes::ConnectionGeometry;
 using QtNodes::TypeConverter;
+using QtNodes::ConnectionStyle;
 
 Connection::
 Connection(PortType portType,
            Node& node,
            PortIndex portIndex)
   : _uid(QUuid::createUuid())
-  , _style(QtNodes::StyleCollection::connectionStyle())
+  , _style(std::make_shared<ConnectionStyle const>(QtNodes::StyleCollection::connectionStyle()))
   , _outPortIndex(INVALID)
   , _inPortIndex(INVALID)
   , _connectionState()
@@ -53,6 +54,7 @@ Connection(Node& nodeIn,
            PortIndex portIndexOut,
            TypeConverter typeConverter)
   : _uid(QUuid::createUuid())
+  , _style(std::make_shared<ConnectionStyle const>())
   , _outNode(&nodeOut)
   , _inNode(&nodeIn)
   , _outPortIndex(portIndexOut)
@@ -10,11 +10,13 @@
 #include "NodeData.hpp"
 
 #include "StyleCollection.hpp"
+#include "LevelOfDetail.hpp"
 
 
 using QtNodes::ConnectionPainter;
 using QtNodes::ConnectionGeometry;
 using QtNodes::Connection;
+using QtNodes::LevelOfDetail;
 
 
 static
@@ -276,11 +278,44 @@ drawNormalLine(QPainter * painter,
 }
 
 
+static
+void
+drawStraightLine(QPainter * painter,
+                 Connection const & connection)
+{
+  auto const & connectionStyle = connection.style();
+
+  bool const selected = connection.connectionGraphicsObject().isSelected();
+
+  QPen p(selected ? connectionStyle.selectedColor() : connectionStyle.normalColor(),
+         connectionStyle.lineWidth());
+
+  painter->save();
+  painter->setRenderHint(QPainter::Antialiasing, false);
+  painter->setPen(p);
+
+  ConnectionGeometry const& geom = connection.connectionGeometry();
+
+  painter->drawLine(geom.source(), geom.sink());
+  painter->restore();
+}
+
+
 void
 ConnectionPainter::
 paint(QPainter* painter,
       Connection const &connection)
 {
+  LevelOfDetail const detail = QtNodes::levelOfDetail(painter);
+
+  // a connection being drawn is always a curve
+  if (detail == LevelOfDetail::Minimal &&
+      !connection.connectionState().requiresPort())
+  {
+    drawStraightLine(painter, connection);
+    return;
+  }
+
   drawHoveredOrSelected(painter, connection);
 
   drawSketchLine(painter, connection);
@@ -291,6 +326,9 @@ paint(QPainter* painter,
   debugDrawing(painter, connection);
 #endif
 
+  if (detail != LevelOfDetail::Full)
+    return;
+
   // draw end points
   ConnectionGeometry const& geom = connection.connectionGeometry();
 
@@ -23,6 +23,7 @@
 #include "ConnectionGraphicsObject.hpp"
 
 #include "Connection.hpp"
+#include "NodeDataModel.hpp"
 
 #include "FlowView.hpp"
 #include "DataModelRegistry.hpp"
@@ -33,6 +34,8 @@ using QtNodes::NodeGraphicsObject;
 using QtNodes::Connection;
 using QtNodes::DataModelRegistry;
 using QtNodes::NodeDataModel;
+using QtNodes::NodeStyle;
+using QtNodes::ConnectionStyle;
 using QtNodes::PortType;
 using QtNodes::PortIndex;
 using QtNodes::TypeConverter;
@@ -413,6 +416,74 @@ getNodeSize(const Node& node) const
 }
 
 
+void
+FlowScene::
+beginStyleUpdate()
+{
+  _styleUpdateDepth++;
+}
+
+
+void
+FlowScene::
+endStyleUpdate()
+{
+  if (_styleUpdateDepth == 0 || --_styleUpdateDepth > 0)
+    return;
+
+  // the scene collects the dirty items until the event loop runs again:
+  // the views repaint once for all of them
+  for (QUuid const& id : _styleDirtyNodes)
+  {
+    auto it = _nodes.find(id);
+    if (it != _nodes.end())
+      it->second->nodeGraphicsObject().update();
+  }
+
+  for (QUuid const& id : _styleDirtyConnections)
+  {
+    auto it = _connections.find(id);
+    if (it != _connections.end())
+      it->second->connectionGraphicsObject().update();
+  }
+
+  _styleDirtyNodes.clear();
+  _styleDirtyConnections.clear();
+}
+
+
+void
+FlowScene::
+setNodeStyle(Node& node, std::shared_ptr<NodeStyle const> style)
+{
+  NodeDataModel* model = node.nodeDataModel();
+  if (&model->nodeStyle() == style.get())
+    return;
+
+  model->setNodeStyle(std::move(style));
+
+  beginStyleUpdate();
+  _styleDirtyNodes.insert(node.id());
+  endStyleUpdate();
+}
+
+
+void
+FlowScene::
+setConnectionStyle(Connection& connection,
+                   std::shared_ptr<ConnectionStyle const> style)
+{
+  if (&connection.style() == style.get())
+    return;
+
+  connection.setStyle(std::move(style));
+
+  beginStyleUpdate();
+  _styleDirtyConnections.insert(connection.id());
+  endStyleUpdate();
+}
+
+
 std::unordered_map<QUuid, std::unique_ptr<Node> > const &
 FlowScene::
 nodes() const
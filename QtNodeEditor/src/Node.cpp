@@ -39,6 +39,9 @@ Node(std::unique_ptr<NodeDataModel> && dataModel)
 
   connect(_nodeDataModel.get(), &NodeDataModel::embeddedWidgetSizeUpdated,
           this, &Node::onNodeSizeUpdated );
+
+  connect(_nodeDataModel.get(), &NodeDataModel::embeddedWidgetChanged,
+          this, &Node::onEmbeddedWidgetChanged );
 }
 
 
@@ -219,6 +222,8 @@ Node::
 onNodeSizeUpdated()
 {
     int prev_width = nodeGeometry().width();
+    // the content may be painted, not only embedded
+    nodeGraphicsObject().setGeometryChanged();
     if( nodeDataModel()->embeddedWidget() )
     {
         nodeDataModel()->embeddedWidget()->adjustSize();
@@ -244,4 +249,17 @@ onNodeSizeUpdated()
             }
         }
     }
+    nodeGraphicsObject().update();
+}
+
+
+void
+Node::
+onEmbeddedWidgetChanged()
+{
+    if( _nodeGraphicsObject )
+    {
+        _nodeGraphicsObject->updateEmbeddedQWidget();
+        onNodeSizeUpdated();
+    }
 }
@@ -91,10 +91,9 @@ recalculateSize() const
     _height = step * maxNumOfEntries;
   }
 
-  if (auto w = _dataModel->embeddedWidget())
-  {
-    _height = std::max(_height, w->height());
-  }
+  QSize const content = contentSize();
+
+  _height = std::max(_height, content.height());
 
   _inputPortWidth  = portWidth(PortType::In);
   _outputPortWidth = portWidth(PortType::Out);
@@ -103,10 +102,7 @@ recalculateSize() const
            _outputPortWidth +
            2 * _spacing;
 
-  if (auto w = _dataModel->embeddedWidget())
-  {
-    _width += w->width();
-  }
+  _width += content.width();
 
   if (_dataModel->validationState() != NodeValidationState::Valid)
   {
@@ -218,19 +214,21 @@ QPointF
 NodeGeometry::
 widgetPosition() const
 {
-  if (auto w = _dataModel->embeddedWidget())
+  QSize const content = contentSize();
+
+  if (content.isEmpty())
   {
-    if (_dataModel->validationState() != NodeValidationState::Valid)
-    {
-      return QPointF(_spacing + portWidth(PortType::In),
-                     ( _height - validationHeight() - _spacing - w->height()) / 2.0);
-    }
+    return QPointF();
+  }
 
+  if (_dataModel->validationState() != NodeValidationState::Valid)
+  {
     return QPointF(_spacing + portWidth(PortType::In),
-                   ( _height - w->height()) / 2.0);
+                   ( _height - validationHeight() - _spacing - content.height()) / 2.0);
   }
 
-  return QPointF();
+  return QPointF(_spacing + portWidth(PortType::In),
+                 ( _height - content.height()) / 2.0);
 }
 
 unsigned int
@@ -288,3 +286,16 @@ portWidth(PortType portType) const
 
   return width;
 }
+
+
+QSize
+NodeGeometry::
+contentSize() const
+{
+  if (auto w = _dataModel->embeddedWidget())
+  {
+    return w->size();
+  }
+
+  return _dataModel->paintedContentSize();
+}
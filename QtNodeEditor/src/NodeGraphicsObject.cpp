@@ -17,10 +17,112 @@
 #include "NodeConnectionInteraction.hpp"
 
 #include "StyleCollection.hpp"
+#include "LevelOfDetail.hpp"
 
 using QtNodes::NodeGraphicsObject;
 using QtNodes::Node;
+using QtNodes::NodeDataModel;
 using QtNodes::FlowScene;
+using QtNodes::LevelOfDetail;
+
+namespace
+{
+
+/// No shadow for the nodes too small to be read.
+class NodeShadowEffect : public QGraphicsDropShadowEffect
+{
+protected:
+
+  void
+  draw(QPainter* painter) override
+  {
+    if (QtNodes::levelOfDetail(painter) == LevelOfDetail::Full)
+      QGraphicsDropShadowEffect::draw(painter);
+    else
+      drawSource(painter);
+  }
+};
+
+/// The embedded widget is skipped too: the node paints its caption instead.
+/// A widget that is not painted takes no input either: the events go to
+/// the node under it, that can be selected and moved.
+class NodeProxyWidget : public QGraphicsProxyWidget
+{
+public:
+
+  using QGraphicsProxyWidget::QGraphicsProxyWidget;
+
+  void
+  paint(QPainter* painter,
+        QStyleOptionGraphicsItem const* option,
+        QWidget* widget) override
+  {
+    if (QtNodes::levelOfDetail(painter) == LevelOfDetail::Full)
+      QGraphicsProxyWidget::paint(painter, option, widget);
+  }
+
+protected:
+
+  bool
+  sceneEvent(QEvent* event) override
+  {
+    if (isInputEvent(event) && !painted(event))
+    {
+      event->ignore();
+      return false;
+    }
+    return QGraphicsProxyWidget::sceneEvent(event);
+  }
+
+private:
+
+  static bool
+  isInputEvent(QEvent const* event)
+  {
+    switch (event->type())
+    {
+      case QEvent::GraphicsSceneMousePress:
+      case QEvent::GraphicsSceneMouseRelease:
+      case QEvent::GraphicsSceneMouseDoubleClick:
+      case QEvent::GraphicsSceneMouseMove:
+      case QEvent::GraphicsSceneHoverEnter:
+      case QEvent::GraphicsSceneHoverMove:
+      case QEvent::GraphicsSceneWheel:
+      case QEvent::GraphicsSceneContextMenu:
+      case QEvent::GraphicsSceneDragEnter:
+      case QEvent::GraphicsSceneDragMove:
+      case QEvent::GraphicsSceneDrop:
+      case QEvent::KeyPress:
+      case QEvent::KeyRelease:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// At the scale of the view the event comes from; the key events,
+  /// that come from no view, use the first one.
+  bool
+  painted(QEvent* event) const
+  {
+    QGraphicsView const* view = nullptr;
+
+    if (event->type() != QEvent::KeyPress &&
+        event->type() != QEvent::KeyRelease)
+    {
+      QWidget const* viewport = static_cast<QGraphicsSceneEvent*>(event)->widget();
+      if (viewport)
+        view = qobject_cast<QGraphicsView const*>(viewport->parentWidget());
+    }
+
+    if (!view && scene() && !scene()->views().isEmpty())
+      view = scene()->views().first();
+
+    return !view ||
+           QtNodes::levelOfDetail(view->transform()) == LevelOfDetail::Full;
+  }
+};
+}
 
 NodeGraphicsObject::
 NodeGraphicsObject(FlowScene &scene,
@@ -44,7 +146,7 @@ NodeGraphicsObject(FlowScene &scene,
   auto const &nodeStyle = node.nodeDataModel()->nodeStyle();
 
   {
-    auto effect = new QGraphicsDropShadowEffect;
+    auto effect = new NodeShadowEffect;
     effect->setOffset(2, 2);
     effect->setBlurRadius(5);
     effect->setColor(nodeStyle.ShadowColor);
@@ -99,7 +201,7 @@ updateEmbeddedQWidget()
 
   if (auto w = _node.nodeDataModel()->embeddedWidget())
   {
-    _proxyWidget = new QGraphicsProxyWidget(this);
+    _proxyWidget = new NodeProxyWidget(this);
 
     _proxyWidget->setWidget(w);
 
@@ -190,6 +292,15 @@ void
 NodeGraphicsObject::
 mousePressEvent(QGraphicsSceneMouseEvent * event)
 {
+  // the content painted in place of the widget may be clicked in a locked node too
+  NodeDataModel* model = _node.nodeDataModel();
+  if (!model->embeddedWidget() &&
+      model->paintedContentPressed(event->pos() - _node.nodeGeometry().widgetPosition()))
+  {
+    event->accept();
+    return;
+  }
+
   if(_locked) return;
 
   // deselect all other items after this one is selected
@@ -369,6 +480,10 @@ hoverEnterEvent(QGraphicsSceneHoverEvent * event)
 
   _node.nodeGeometry().setHovered(true);
   update();
+
+  // a painted node gets its editor only when the user gets close to it
+  _node.nodeDataModel()->requestEmbeddedWidget();
+
   _scene.nodeHovered(node(), event->screenPos());
   event->accept();
 }
@@ -1,5 +1,6 @@
 #include "NodePainter.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QtCore/QMargins>
@@ -12,6 +13,7 @@
 #include "NodeDataModel.hpp"
 #include "Node.hpp"
 #include "FlowScene.hpp"
+#include "LevelOfDetail.hpp"
 #include <QSvgRenderer>
 
 using QtNodes::NodePainter;
@@ -21,6 +23,7 @@ using QtNodes::Node;
 using QtNodes::NodeState;
 using QtNodes::NodeDataModel;
 using QtNodes::FlowScene;
+using QtNodes::LevelOfDetail;
 
 void
 NodePainter::
@@ -39,8 +42,22 @@ paint(QPainter* painter,
   //--------------------------------------------
   NodeDataModel const * model = node.nodeDataModel();
 
+  LevelOfDetail const detail = QtNodes::levelOfDetail(painter);
+
+  if (detail == LevelOfDetail::Minimal)
+  {
+    drawMinimalRect(painter, geom, model, graphicsObject);
+    return;
+  }
+
   drawNodeRect(painter, geom, model, graphicsObject);
 
+  if (detail == LevelOfDetail::Simplified)
+  {
+    drawCaption(painter, geom, model);
+    return;
+  }
+
   drawConnectionPoints(painter, geom, state, model, scene);
 
   drawFilledConnectionPoints(painter, geom, state, model);
@@ -103,6 +120,60 @@ drawNodeRect(QPainter* painter,
 }
 
 
+void
+NodePainter::
+drawMinimalRect(QPainter* painter,
+                NodeGeometry const& geom,
+                NodeDataModel const* model,
+                NodeGraphicsObject const & graphicsObject)
+{
+  NodeStyle const& nodeStyle = model->nodeStyle();
+
+  auto color = graphicsObject.isSelected()
+               ? nodeStyle.SelectedBoundaryColor
+               : nodeStyle.NormalBoundaryColor;
+
+  painter->save();
+  painter->setRenderHint(QPainter::Antialiasing, false);
+  painter->setPen(QPen(color, nodeStyle.PenWidth));
+  painter->setBrush(nodeStyle.GradientColor1);
+
+  float diam = nodeStyle.ConnectionPointDiameter;
+
+  painter->drawRect(QRectF(-diam, -diam, 2.0 * diam + geom.width(), 2.0 * diam + geom.height()));
+  painter->restore();
+}
+
+
+void
+NodePainter::
+drawCaption(QPainter* painter,
+            NodeGeometry const& geom,
+            NodeDataModel const* model)
+{
+  QString const caption = model->caption();
+
+  if (caption.isEmpty())
+    return;
+
+  // as large as the node allows, to be read from afar
+  QFont font = painter->font();
+  font.setBold(true);
+
+  QFontMetricsF metrics(font);
+  double const scale = std::min(0.9 * geom.width() / std::max(1.0, metrics.width(caption)),
+                                0.5 * geom.height() / metrics.height());
+  font.setPointSizeF(font.pointSizeF() * scale);
+
+  painter->save();
+  painter->setFont(font);
+  painter->setPen(model->nodeStyle().FontColor);
+  painter->drawText(QRectF(0, 0, geom.width(), geom.height()),
+                    Qt::AlignCenter, caption);
+  painter->restore();
+}
+
+
 void
 NodePainter::
 drawConnectionPoints(QPainter* painter,
@@ -34,6 +34,19 @@ public:
                NodeDataModel const* model,
                NodeGraphicsObject const & graphicsObject);
 
+  static
+  void
+  drawMinimalRect(QPainter* painter,
+                  NodeGeometry const& geom,
+                  NodeDataModel const* model,
+                  NodeGraphicsObject const & graphicsObject);
+
+  static
+  void
+  drawCaption(QPainter* painter,
+              NodeGeometry const& geom,
+              NodeDataModel const* model);
+
   static
   void
   drawEntryLabels(QPainter* painter,
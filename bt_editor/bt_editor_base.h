@@ -4,9 +4,9 @@
 #include <QString>
 #include <QPointF>
 #include <QSizeF>
+#include <QMetaType>
 #include <map>
 #include <unordered_map>
-#include <nodes/Node>
 #include <deque>
 
 #include <behaviortree_cpp_v3/bt_factory.h>
@@ -14,6 +14,11 @@
 #include "convert.h"
 
 
+// only a pointer here: this header is used by groot-replay, without QtWidgets
+namespace QtNodes{
+class Node;
+}
+
 using roseus_bt::NodeType;
 using BT::NodeStatus;
 // using BT::NodeType;
@@ -61,8 +61,13 @@ void EditorFlowScene::keyPressEvent(QKeyEvent *event)
 
     for( const auto& it: nodes())
     {
-        const auto& node = it.second;
-        auto line_edits = node->nodeDataModel()->embeddedWidget()->findChildren<QLineEdit*>();
+        // a paint-only node has nothing to edit
+        auto widget = it.second->nodeDataModel()->embeddedWidget();
+        if( !widget )
+        {
+            continue;
+        }
+        auto line_edits = widget->findChildren<QLineEdit*>();
         for(auto line_edit: line_edits )
         {
             if( line_edit->hasFocus() )
@@ -0,0 +1,247 @@
+#include "fbl_log.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <map>
+#include <set>
+
+FblError ParseFblLayout(const char* buffer, size_t size, FblLayout* layout)
+{
+    // we need at least 4 bytes to read the header size
+    if( size < 4 )
+    {
+        return FblError::EMPTY;
+    }
+    const size_t header_size = flatbuffers::ReadScalar<uint32_t>(buffer);
+
+    // if the length of the header goes past the end of the file, it is invalid
+    if( header_size == 0 || header_size > size - 4 )
+    {
+        return FblError::CORRUPT;
+    }
+
+    // only the header: the transitions are not part of the flatbuffer
+    flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(buffer + 4), header_size );
+    if( !Serialization::VerifyBehaviorTreeBuffer(verifier) )
+    {
+        return FblError::INCOMPATIBLE;
+    }
+    if( !IsConsistentTree( Serialization::GetBehaviorTree( buffer + 4 ) ) )
+    {
+        return FblError::CORRUPT;
+    }
+
+    layout->header_size = header_size;
+    layout->first_record = 4 + header_size;
+    layout->records_count = (size - layout->first_record) / TransitionDecoder::RECORD_SIZE;
+    return FblError::NONE;
+}
+
+const char* toStr(FblError error)
+{
+    switch (error)
+    {
+    case FblError::NONE:         return "no error";
+    case FblError::EMPTY:        return "this Log file is empty";
+    case FblError::CORRUPT:      return "this Log file corrupted or truncated";
+    case FblError::INCOMPATIBLE: return "its format is not compatible with the current one";
+    }
+    return nullptr;
+}
+
+bool IsConsistentTree(const Serialization::BehaviorTree *fb_behavior_tree)
+{
+    const auto fb_nodes = fb_behavior_tree->nodes();
+    if( !fb_nodes || fb_nodes->size() == 0 )
+    {
+        return false;
+    }
+
+    std::set<QString> models;
+    if( fb_behavior_tree->node_models() )
+    {
+        for( const Serialization::NodeModel* model_node: *(fb_behavior_tree->node_models()) )
+        {
+            if( !model_node->registration_name() )
+            {
+                return false;
+            }
+            models.insert( model_node->registration_name()->c_str() );
+        }
+    }
+
+    std::map<uint16_t, int> parents;
+    for( const Serialization::TreeNode* fb_node: *fb_nodes )
+    {
+        if( !fb_node->instance_name() || !fb_node->registration_name() ||
+            models.count( fb_node->registration_name()->c_str() ) == 0 ||
+            !parents.insert( { fb_node->uid(), 0 } ).second )
+        {
+            return false;
+        }
+    }
+    for( const Serialization::TreeNode* fb_node: *fb_nodes )
+    {
+        if( !fb_node->children_uid() )
+        {
+            continue;
+        }
+        for( const auto child_uid: *(fb_node->children_uid()) )
+        {
+            auto it = parents.find( child_uid );
+            if( it == parents.end() || it->second > 0 || child_uid == fb_nodes->Get(0)->uid() )
+            {
+                return false;
+            }
+            it->second++;
+        }
+    }
+    return true;
+}
+
+std::pair<AbsBehaviorTree, UidTable>
+BuildTreeFromFlatbuffers(const Serialization::BehaviorTree *fb_behavior_tree)
+{
+    AbsBehaviorTree tree;
+    UidTable uid_to_index;
+
+    AbstractTreeNode abs_root;
+    abs_root.instance_name = "Root";
+    abs_root.model.registration_ID = "Root";
+    abs_root.model.registration_ID = "Root";
+    abs_root.children_index.push_back( 1 );
+
+    tree.addNode( nullptr, std::move(abs_root) );
+
+    // the vectors and strings of a flatbuffer are optional: the missing ones are empty
+    auto str = [](const flatbuffers::String* s)
+    {
+        return s ? QString( s->c_str() ) : QString();
+    };
+
+    //-----------------------------------------
+    NodeModels models;
+
+    if( fb_behavior_tree->node_models() )
+    {
+        for( const Serialization::NodeModel* model_node: *(fb_behavior_tree->node_models()) )
+        {
+            NodeModel model;
+            model.registration_ID = str( model_node->registration_name() );
+            model.type = convert( model_node->type() );
+
+            if( model_node->ports() )
+            {
+                for( const Serialization::PortModel* port: *(model_node->ports()) )
+                {
+                    PortModel port_model;
+                    QString port_name = str( port->port_name() );
+                    port_model.direction = convert( port->direction() );
+                    port_model.type_name = str( port->type_info() );
+                    port_model.description = str( port->description() );
+
+                    model.ports.insert( { port_name, std::move(port_model) } );
+                }
+            }
+
+            models.insert( { model.registration_ID, std::move(model)} );
+        }
+    }
+
+    //-----------------------------------------
+    for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
+    {
+        AbstractTreeNode abs_node;
+        abs_node.instance_name = str( fb_node->instance_name() );
+        const QString registration_ID = str( fb_node->registration_name() );
+        abs_node.status = convert( fb_node->status() );
+        abs_node.model = (models.at(registration_ID));
+
+        if( fb_node->port_remaps() )
+        {
+            for( const Serialization::PortConfig* pair: *(fb_node->port_remaps()) )
+            {
+                abs_node.ports_mapping.insert( { str( pair->port_name() ),
+                                                 str( pair->remap() ) } );
+            }
+        }
+        int index = tree.nodesCount();
+        abs_node.index = index;
+        tree.nodes().push_back( std::move(abs_node) );
+        uid_to_index.insert( fb_node->uid(), index );
+    }
+
+    for(size_t index = 0; index < fb_behavior_tree->nodes()->size(); index++ )
+    {
+        const Serialization::TreeNode* fb_node = fb_behavior_tree->nodes()->Get(index);
+        AbstractTreeNode* abs_node = tree.node( index + 1);
+        if( !fb_node->children_uid() )
+        {
+            continue;
+        }
+        for( const auto child_uid: *(fb_node->children_uid()) )
+        {
+            int child_index = uid_to_index.indexOf( child_uid );
+            if( child_index >= 0 )
+            {
+                abs_node->children_index.push_back(child_index);
+            }
+        }
+    }
+    return { tree, uid_to_index };
+}
+
+QByteArray TreeStructureHash(const Serialization::BehaviorTree *fb_behavior_tree)
+{
+    QByteArray structure;
+    QDataStream stream( &structure, QIODevice::WriteOnly );
+
+    // optional strings are written as empty ones
+    auto write = [&stream](const flatbuffers::String* str)
+    {
+        stream << ( str ? QByteArray( str->c_str(), int(str->size()) ) : QByteArray() );
+    };
+
+    stream << quint16( fb_behavior_tree->root_uid() );
+    if( fb_behavior_tree->node_models() )
+    {
+        for( const Serialization::NodeModel* model_node: *(fb_behavior_tree->node_models()) )
+        {
+            write( model_node->registration_name() );
+            stream << qint32( model_node->type() );
+            const auto ports = model_node->ports();
+            stream << quint32( ports ? ports->size() : 0 );
+            for( size_t i = 0; ports && i < ports->size(); i++ )
+            {
+                const Serialization::PortModel* port = ports->Get(i);
+                write( port->port_name() );
+                stream << qint32( port->direction() );
+                write( port->type_info() );
+                write( port->description() );
+            }
+        }
+    }
+    if( fb_behavior_tree->nodes() )
+    {
+        for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
+        {
+            stream << quint16( fb_node->uid() );
+            write( fb_node->instance_name() );
+            write( fb_node->registration_name() );
+
+            const auto children = fb_node->children_uid();
+            stream << quint32( children ? children->size() : 0 );
+            for( size_t i = 0; children && i < children->size(); i++ )
+            {
+                stream << quint16( children->Get(i) );
+            }
+            const auto remaps = fb_node->port_remaps();
+            stream << quint32( remaps ? remaps->size() : 0 );
+            for( size_t i = 0; remaps && i < remaps->size(); i++ )
+            {
+                write( remaps->Get(i)->port_name() );
+                write( remaps->Get(i)->remap() );
+            }
+        }
+    }
+    return QCryptographicHash::hash( structure, QCryptographicHash::Sha1 );
+}
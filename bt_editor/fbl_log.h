@@ -0,0 +1,42 @@
+#ifndef FBL_LOG_H
+#define FBL_LOG_H
+
+#include "bt_editor_base.h"
+#include "transition_log.h"
+#include <behaviortree_cpp_v3/flatbuffers/BT_logger_generated.h>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+
+// Reading of the .fbl files written by BT::FileLogger. Nothing here depends
+// on QtWidgets: it is shared by the replay panel and the groot-replay tool.
+//
+// Layout of the file:
+//   uint32 header size | BehaviorTree flatbuffer | 12 bytes transitions ...
+struct FblLayout
+{
+    size_t header_size = 0;
+    size_t first_record = 0;   // offset of the first transition
+    size_t records_count = 0;  // a record truncated at the end is not counted
+};
+
+enum class FblError { NONE, EMPTY, CORRUPT, INCOMPATIBLE };
+
+// Check the header of a log and locate its transitions
+FblError ParseFblLayout(const char* buffer, size_t size, FblLayout* layout);
+
+const char* toStr(FblError error);
+
+// Every child and every registration name refers to an entry of the buffer, and
+// every node but the first one (the root) has at most one parent: no cycle can
+// be reached from the root. Checked by ParseFblLayout.
+bool IsConsistentTree(const Serialization::BehaviorTree* bt );
+
+// the tree and the index of each node uid in it; the unknown children are skipped
+// and the missing optional vectors and strings are read as empty
+std::pair<AbsBehaviorTree, UidTable>
+BuildTreeFromFlatbuffers(const Serialization::BehaviorTree* bt );
+
+// SHA-1 of the structure of the tree: uids, children, names, models and ports.
+// The status of the nodes is left out, so the same tree sent twice has the same hash.
+QByteArray TreeStructureHash(const Serialization::BehaviorTree* bt );
+
+#endif // FBL_LOG_H
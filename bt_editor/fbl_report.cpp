@@ -0,0 +1,217 @@
+#include "fbl_report.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+
+#include "fbl_log.h"
+#include "transition_log.h"
+
+// The tree fails because of its child that failed last, and so on down to a leaf.
+static QString failurePath(const AbsBehaviorTree& tree,
+                           const std::vector<int64_t>& failure_row,
+                           const std::vector<size_t>& failure_tick,
+                           size_t tick)
+{
+    const int nodes_count = int( tree.nodesCount() );
+    QStringList names;
+    int current = 1;
+    // a path longer than the tree would loop forever
+    while( current >= 0 && names.size() < nodes_count )
+    {
+        names.push_back( tree.node(current)->instance_name );
+        int next = -1;
+        int64_t last_row = -1;
+        for (int child: tree.node(current)->children_index)
+        {
+            if( child < 0 || child >= nodes_count )
+            {
+                continue;
+            }
+            if( failure_tick[child] == tick && failure_row[child] > last_row )
+            {
+                last_row = failure_row[child];
+                next = child;
+            }
+        }
+        current = next;
+    }
+    return names.join(" > ");
+}
+
+LogReport AnalyzeLog(const QString& filename)
+{
+    LogReport report;
+    report.filename = filename;
+
+    QFile file(filename);
+    if( !file.open(QIODevice::ReadOnly) )
+    {
+        report.error = file.errorString();
+        return report;
+    }
+
+    const qint64 file_size = file.size();
+    QByteArray content;
+    const char* buffer = (file_size > 0) ? reinterpret_cast<const char*>( file.map(0, file_size) ) : nullptr;
+    if( !buffer )
+    {
+        content = file.readAll();
+        buffer = content.constData();
+    }
+
+    FblLayout layout;
+    const FblError error = ParseFblLayout( buffer, size_t(file_size), &layout );
+    if( error != FblError::NONE )
+    {
+        report.error = toStr(error);
+        return report;
+    }
+
+    auto res_pair = BuildTreeFromFlatbuffers( Serialization::GetBehaviorTree( &buffer[4] ) );
+    const AbsBehaviorTree& tree = res_pair.first;
+    const size_t nodes_count = tree.nodesCount();
+
+    TransitionDecoder decoder( res_pair.second, int(nodes_count) );
+    TransitionLog log;
+    log.reserve( layout.records_count );
+
+    const size_t decoded = decoder.decode( buffer + layout.first_record, layout.records_count, log );
+    if( decoded < layout.records_count )
+    {
+        // keep the statistics of what could be decoded
+        report.error = QString("unknown node uid in transition %1").arg(decoded);
+    }
+
+    report.transitions = log.size();
+    if( !log.empty() )
+    {
+        report.duration = log.timestamp( log.size()-1 ) - log.timestamp(0);
+    }
+
+    TransitionStats stats;
+    stats.reset( nodes_count );
+    stats.append( log, 0 );
+
+    std::vector<int64_t> failure_row( nodes_count, -1 );
+    std::vector<size_t> failure_tick( nodes_count, 0 );
+    size_t tick = 1;
+
+    for (size_t row = 0; row < log.size(); row++)
+    {
+        if( log.isTreeRestart(row) )
+        {
+            tick++;
+        }
+        if( log.status(row) != NodeStatus::FAILURE )
+        {
+            continue;
+        }
+        const int index = log.nodeIndex(row);
+        failure_row[index] = int64_t(row);
+        failure_tick[index] = tick;
+
+        if( index == 1 )
+        {
+            report.failure_paths[ failurePath( tree, failure_row, failure_tick, tick ) ]++;
+        }
+    }
+
+    for (size_t index = 1; index < nodes_count; index++)
+    {
+        NodeReport node;
+        node.name = tree.node(index)->instance_name;
+        node.registration_ID = tree.node(index)->model.registration_ID;
+        node.summary = stats.summary(index);
+        report.nodes.push_back( std::move(node) );
+    }
+    return report;
+}
+
+static QString csvField(const QString& text)
+{
+    if( !text.contains(',') && !text.contains('"') && !text.contains('\n') )
+    {
+        return text;
+    }
+    QString escaped = text;
+    escaped.replace("\"", "\"\"");
+    return "\"" + escaped + "\"";
+}
+
+void WriteCsv(QTextStream& out, const QList<LogReport>& reports)
+{
+    out << "file,node,model,ticks,success,failure,success_ratio,"
+           "running_count,running_min,running_mean,running_p95,running_max,running_total\n";
+
+    for (const LogReport& report: reports)
+    {
+        for (const NodeReport& node: report.nodes)
+        {
+            const auto& summary = node.summary;
+            out << csvField(report.filename) << ','
+                << csvField(node.name) << ','
+                << csvField(node.registration_ID) << ','
+                << summary.ticks << ','
+                << summary.success << ','
+                << summary.failure << ','
+                << summary.successRatio() << ','
+                << summary.running_count << ','
+                << summary.running_min << ','
+                << summary.running_mean << ','
+                << summary.running_p95 << ','
+                << summary.running_max << ','
+                << summary.running_total << '\n';
+        }
+    }
+}
+
+QJsonDocument ReportsToJson(const QList<LogReport>& reports)
+{
+    QJsonArray logs;
+    for (const LogReport& report: reports)
+    {
+        QJsonObject log;
+        log["file"] = report.filename;
+        if( !report.error.isEmpty() )
+        {
+            log["error"] = report.error;
+        }
+        log["transitions"] = double(report.transitions);
+        log["duration"] = report.duration;
+
+        QJsonArray nodes;
+        for (const NodeReport& node: report.nodes)
+        {
+            const auto& summary = node.summary;
+            QJsonObject json_node;
+            json_node["name"] = node.name;
+            json_node["model"] = node.registration_ID;
+            json_node["ticks"] = summary.ticks;
+            json_node["success"] = summary.success;
+            json_node["failure"] = summary.failure;
+            json_node["running_count"] = summary.running_count;
+            json_node["running_min"] = summary.running_min;
+            json_node["running_mean"] = summary.running_mean;
+            json_node["running_p95"] = summary.running_p95;
+            json_node["running_max"] = summary.running_max;
+            json_node["running_total"] = summary.running_total;
+            nodes.append( json_node );
+        }
+        log["nodes"] = nodes;
+
+        QJsonArray failures;
+        for (const auto& it: report.failure_paths)
+        {
+            QJsonObject failure;
+            failure["path"] = it.first;
+            failure["count"] = it.second;
+            failures.append( failure );
+        }
+        log["failure_paths"] = failures;
+
+        logs.append( log );
+    }
+    return QJsonDocument( logs );
+}
@@ -0,0 +1,44 @@
+#ifndef FBL_REPORT_H
+#define FBL_REPORT_H
+
+#include <QString>
+#include <QList>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <map>
+#include <vector>
+
+#include "transition_stats.h"
+
+// What groot-replay computes for each .fbl log: the statistics of every node
+// and the paths of the failures of the tree.
+
+struct NodeReport
+{
+    QString name;
+    QString registration_ID;
+    TransitionStats::Summary summary;
+};
+
+struct LogReport
+{
+    QString filename;
+    QString error;
+    size_t transitions = 0;
+    double duration = 0;
+    std::vector<NodeReport> nodes;
+
+    // path from the root to the node that caused a failure of the tree -> count
+    std::map<QString, int> failure_paths;
+};
+
+// Parse and analyze a whole log. A log that can't be read at all has no nodes;
+// error is set for a partial analysis too.
+LogReport AnalyzeLog(const QString& filename);
+
+// one row per node of each log
+void WriteCsv(QTextStream& out, const QList<LogReport>& reports);
+
+QJsonDocument ReportsToJson(const QList<LogReport>& reports);
+
+#endif // FBL_REPORT_H
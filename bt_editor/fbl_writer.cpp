@@ -0,0 +1,139 @@
+#include "fbl_writer.h"
+
+#include "transition_log.h"
+#include <chrono>
+#include <QDebug>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+
+FblWriter::FblWriter():
+    _stop(false),
+    _open(false),
+    _failed(false),
+    _size(0),
+    _dropped_records(0)
+{
+}
+
+FblWriter::~FblWriter()
+{
+    close();
+}
+
+bool FblWriter::open(const QString &filename, const QByteArray &serialized_tree, QString *error)
+{
+    close();
+
+    _file.setFileName( filename );
+    if( !_file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+    {
+        *error = _file.errorString();
+        return false;
+    }
+
+    // | header size | BehaviorTree flatbuffer |, the same header as BT::FileLogger
+    char header_size[4];
+    flatbuffers::WriteScalar<uint32_t>( header_size, static_cast<uint32_t>(serialized_tree.size()) );
+    if( _file.write( header_size, 4 ) != 4 ||
+        _file.write( serialized_tree ) != serialized_tree.size() )
+    {
+        *error = _file.errorString();
+        _file.close();
+        return false;
+    }
+
+    _size = 4 + uint64_t(serialized_tree.size());
+    _dropped_records = 0;
+    _error.clear();
+    _pending.reserve( FLUSH_SIZE * 2 );
+    _stop = false;
+    _open = true;
+    _thread = std::thread( &FblWriter::run, this );
+    return true;
+}
+
+void FblWriter::close()
+{
+    if( !_thread.joinable() )
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = false;
+        _stop = true;
+    }
+    _cond.notify_one();
+    _thread.join();
+    _file.close();
+    _failed = false;
+}
+
+QString FblWriter::error() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _error;
+}
+
+void FblWriter::append(const char *records, size_t size)
+{
+    bool flush = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( !_open )
+        {
+            return;
+        }
+        // whole messages are dropped, so that the records stay aligned
+        if( _pending.size() + size > MAX_PENDING )
+        {
+            _dropped_records += size / TransitionDecoder::RECORD_SIZE;
+            return;
+        }
+        _pending.insert( _pending.end(), records, records + size );
+        flush = ( _pending.size() >= FLUSH_SIZE );
+    }
+    _size += size;
+    if( flush )
+    {
+        _cond.notify_one();
+    }
+}
+
+void FblWriter::run()
+{
+    // swapped with _pending, so that neither buffer is reallocated
+    std::vector<char> writing;
+    writing.reserve( FLUSH_SIZE * 2 );
+
+    bool stop = false;
+    while( !stop )
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cond.wait_for( lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]()
+            {
+                return _stop || _pending.size() >= FLUSH_SIZE;
+            });
+            stop = _stop;
+            std::swap( writing, _pending );
+        }
+
+        if( !writing.empty() )
+        {
+            // after a short write the following records would be misaligned: stop there
+            if( _file.write( writing.data(), qint64(writing.size()) ) != qint64(writing.size()) ||
+                !_file.flush() )
+            {
+                qDebug() << "Writing the log failed: " << _file.errorString();
+                std::lock_guard<std::mutex> lock(_mutex);
+                _error = _file.errorString();
+                _open = false;
+                _pending.clear();
+                _pending.shrink_to_fit();
+                _failed = true;
+                return;
+            }
+            writing.clear();
+        }
+    }
+}
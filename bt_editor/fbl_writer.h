@@ -0,0 +1,70 @@
+#ifndef FBL_WRITER_H
+#define FBL_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+
+// Writes a .fbl file (the format read by SidepanelReplay) from a stream of
+// transitions. append() only copies the records into a buffer; a background
+// thread writes that buffer to disk in large blocks, so the producer (e.g.
+// the thread receiving the monitor messages) is never blocked by the disk.
+// A failed write stops the recording: the file ends with the last complete record.
+class FblWriter
+{
+public:
+    FblWriter();
+
+    ~FblWriter();
+
+    // write the header (the serialized BehaviorTree) and start the writer thread
+    bool open(const QString& filename, const QByteArray& serialized_tree, QString* error);
+
+    // flush what is buffered and close the file
+    void close();
+
+    bool isOpen() const { return _open; }
+
+    // thread safe. Records are 12 bytes transitions; ignored if no file is open.
+    // Dropped, and counted, when the disk falls behind by more than MAX_PENDING
+    void append(const char* records, size_t size);
+
+    // bytes of the file, header included, buffered or already written
+    uint64_t size() const { return _size; }
+
+    uint64_t droppedRecords() const { return _dropped_records; }
+
+    // true if a write failed; the file is not open anymore. Cleared by close()
+    bool hasFailed() const { return _failed; }
+
+    QString error() const;
+
+private:
+    void run();
+
+    static const size_t FLUSH_SIZE = 256 * 1024;
+    static const int FLUSH_INTERVAL_MS = 500;
+    static const size_t MAX_PENDING = 64 * 1024 * 1024;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+    std::vector<char> _pending;
+    bool _stop;
+    QString _error;
+
+    std::atomic<bool> _open;
+    std::atomic<bool> _failed;
+    std::atomic<uint64_t> _size;
+    std::atomic<uint64_t> _dropped_records;
+
+    // used only by the writer thread while it runs
+    QFile _file;
+    std::thread _thread;
+};
+
+#endif // FBL_WRITER_H
@@ -18,11 +18,21 @@ GraphicContainer::GraphicContainer(std::shared_ptr<DataModelRegistry> model_regi
                                    QWidget *parent) :
     QObject(parent),
     _model_registry( std::move(model_registry) ),
-    _signal_was_blocked(true)
+    _signal_was_blocked(true),
+    _index_dirty(true)
 {
     _scene = new EditorFlowScene( _model_registry, parent );
     _view  = new QtNodes::FlowView( _scene, parent );
 
+    // anything that can change the index of a node. Moving a node can change
+    // the order of its siblings.
+    auto invalidateIndex = [this]() { _index_dirty = true; };
+    connect( _scene, &QtNodes::FlowScene::nodeCreated, this, invalidateIndex );
+    connect( _scene, &QtNodes::FlowScene::nodeDeleted, this, invalidateIndex );
+    connect( _scene, &QtNodes::FlowScene::nodeMoved, this, invalidateIndex );
+    connect( _scene, &QtNodes::FlowScene::connectionCreated, this, invalidateIndex );
+    connect( _scene, &QtNodes::FlowScene::connectionDeleted, this, invalidateIndex );
+
     connect( _scene, &QtNodes::FlowScene::nodeDoubleClicked,
              this, &GraphicContainer::onNodeDoubleClicked);
 
@@ -157,6 +167,8 @@ void GraphicContainer::nodeReorder()
 {
     {
         const QSignalBlocker blocker(this);
+        // setNodePosition() does not emit nodeMoved
+        _index_dirty = true;
         auto abstract_tree = BuildTreeFromScene( _scene );
         NodeReorder( *_scene, abstract_tree );
         zoomHomeView();
@@ -262,6 +274,40 @@ std::set<QtNodes::Node*> GraphicContainer::getSubtreeNodesRecursively(Node &root
     return nodes;
 }
 
+const std::vector<GraphicContainer::IndexedNode>& GraphicContainer::indexedNodes()
+{
+    if( !_index_dirty )
+    {
+        return _indexed_nodes;
+    }
+    _indexed_nodes.clear();
+    _index_dirty = false;
+
+    // same order as BuildTreeFromScene(): depth first, children sorted by position
+    std::function<void(QtNodes::Node*)> pushRecursively = [&](QtNodes::Node* node)
+    {
+        QtNodes::Connection* connection_in = nullptr;
+        const auto& connections = node->nodeState().connections( PortType::In, 0 );
+        if( connections.size() == 1 )
+        {
+            connection_in = connections.begin()->second;
+        }
+        _indexed_nodes.push_back( { node, connection_in } );
+
+        for (auto child: getChildren( *_scene, *node, true ))
+        {
+            pushRecursively( child );
+        }
+    };
+
+    QtNodes::Node* root_node = findRoot( *_scene );
+    if( root_node )
+    {
+        pushRecursively( root_node );
+    }
+    return _indexed_nodes;
+}
+
 void GraphicContainer::createSubtree(Node &root_node, QString subtree_name )
 {
     bool ok = false;
@@ -347,7 +393,7 @@ void GraphicContainer::onNodeCreated(Node &node)
             auto main_win = dynamic_cast<MainWindow*>( parent() );
             if( main_win && main_win->getTabByName( bt_node->registrationName() ) == nullptr  )
             {
-                subtree_node->expandButton()->setEnabled(true);
+                subtree_node->setExpandButtonEnabled(true);
             }
             connect( subtree_node, &SubtreeNodeModel::expandButtonPushed,
                      &(node), [&node, this]()
@@ -467,6 +513,8 @@ QtNodes::Node* GraphicContainer::substituteNode(Node *old_node, const QString& n
 
 void GraphicContainer::deleteSubTreeRecursively(Node &root_node)
 {
+    // nodeDeleted is blocked below
+    _index_dirty = true;
     const QSignalBlocker blocker1( this );
     const QSignalBlocker blocker2( _scene );
     auto nodes_to_delete = getSubtreeNodesRecursively(root_node);
@@ -651,7 +699,7 @@ void GraphicContainer::recursiveLoadStep(QPointF& cursor,
         {
             subtree_node->setExpanded(true);
             new_node.nodeState().getEntries(PortType::Out).resize(1);
-            subtree_node->expandButton()->setHidden( true );
+            subtree_node->setExpandButtonVisible( false );
             emit subtree_node->updateNodeSize();
         }
     }
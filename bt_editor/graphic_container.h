@@ -59,6 +59,15 @@ public:
 
     void createSubtree(QtNodes::Node& root_node, QString subtree_name = QString());
 
+    struct IndexedNode{
+        QtNodes::Node* node;
+        QtNodes::Connection* connection_in;   // from the parent, nullptr for the root
+    };
+
+    // The graphic node of each index of BuildTreeFromScene( scene() ), without
+    // building the tree. The table is built again only after the scene changed.
+    const std::vector<IndexedNode>& indexedNodes();
+
 public slots:
 
     void onNodeDoubleClicked(QtNodes::Node& root_node);
@@ -102,6 +111,9 @@ private:
 
    bool _signal_was_blocked;
 
+   std::vector<IndexedNode> _indexed_nodes;
+   bool _index_dirty;
+
 };
 
 #endif // GRAPHIC_CONTAINER_H
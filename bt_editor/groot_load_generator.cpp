@@ -0,0 +1,157 @@
+// groot-load-generator: a fake BT::PublisherZMQ, to benchmark the monitor.
+//
+// Serves a synthetic tree of any size and publishes random status changes
+// at a fixed rate (see MonitorLoadGenerator). Connect Groot in monitor mode
+// to the same ports and read the metrics in the monitor panel.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+#include <iostream>
+
+#include "monitor_load_generator.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("groot-load-generator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Publish a synthetic BehaviorTree over ZMQ, like BT::PublisherZMQ");
+    parser.addHelpOption();
+
+    MonitorLoadGenerator::Options options;
+
+    QCommandLineOption nodes_option(QStringList() << "n" << "nodes",
+                                    QString("Nodes of the tree (default: %1)").arg(options.nodes),
+                                    "N");
+    parser.addOption(nodes_option);
+
+    QCommandLineOption fanout_option(QStringList() << "fanout",
+                                     QString("Children of each control node, at least 2 (default: %1)").arg(options.fanout),
+                                     "N");
+    parser.addOption(fanout_option);
+
+    QCommandLineOption rate_option(QStringList() << "r" << "rate",
+                                   QString("Messages per second (default: %1)").arg(options.messages_rate),
+                                   "N");
+    parser.addOption(rate_option);
+
+    QCommandLineOption transitions_option(QStringList() << "t" << "transitions",
+                                          QString("Transitions per message (default: %1)").arg(options.transitions_per_message),
+                                          "N");
+    parser.addOption(transitions_option);
+
+    QCommandLineOption publisher_option(QStringList() << "publisher-port",
+                                        QString("Port of the PUB socket (default: %1)").arg(options.publisher_port),
+                                        "port");
+    parser.addOption(publisher_option);
+
+    QCommandLineOption server_option(QStringList() << "server-port",
+                                     QString("Port of the REP socket serving the tree (default: %1)").arg(options.server_port),
+                                     "port");
+    parser.addOption(server_option);
+
+    QCommandLineOption duration_option(QStringList() << "d" << "duration",
+                                       "Stop after this many seconds (default: never)",
+                                       "seconds");
+    parser.addOption(duration_option);
+
+    QCommandLineOption xml_option(QStringList() << "print-xml",
+                                  "Print the XML of the tree and exit");
+    parser.addOption(xml_option);
+    parser.process( app );
+
+    // every value is a positive number
+    auto readValue = [&parser](const QCommandLineOption& option, double minimum, double* value)
+    {
+        if( !parser.isSet(option) )
+        {
+            return true;
+        }
+        bool ok = false;
+        const double read = parser.value(option).toDouble(&ok);
+        if( !ok || read < minimum )
+        {
+            std::cerr << "wrong value passed to --" << option.names().last().toStdString() << std::endl;
+            return false;
+        }
+        *value = read;
+        return true;
+    };
+
+    double nodes = options.nodes;
+    double fanout = options.fanout;
+    double transitions = options.transitions_per_message;
+    double publisher_port = options.publisher_port;
+    double server_port = options.server_port;
+    double duration = 0;
+
+    // the uids of BT::PublisherZMQ are 16 bits
+    if( !readValue( nodes_option, 1, &nodes ) || nodes > 65535 ||
+        !readValue( fanout_option, 2, &fanout ) ||
+        !readValue( rate_option, 0.001, &options.messages_rate ) ||
+        !readValue( transitions_option, 0, &transitions ) ||
+        !readValue( publisher_option, 1, &publisher_port ) ||
+        !readValue( server_option, 1, &server_port ) ||
+        !readValue( duration_option, 0, &duration ) )
+    {
+        return 1;
+    }
+    options.nodes = int(nodes);
+    options.fanout = int(fanout);
+    options.transitions_per_message = int(transitions);
+    options.publisher_port = int(publisher_port);
+    options.server_port = int(server_port);
+
+    if( parser.isSet(xml_option) )
+    {
+        std::cout << MonitorLoadGenerator::treeXML( options.nodes, options.fanout );
+        return 0;
+    }
+
+    zmq::context_t context(1);
+    MonitorLoadGenerator generator( context, options );
+    std::string error;
+    if( !generator.start( &error ) )
+    {
+        std::cerr << "can't bind the sockets: " << error << std::endl;
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    out << "Publishing " << options.nodes << " nodes on port " << options.publisher_port
+        << ", tree served on port " << options.server_port << endl;
+
+    // one line per second: what was actually sent
+    QElapsedTimer clock;
+    clock.start();
+    uint64_t last_messages = 0;
+    uint64_t last_transitions = 0;
+
+    QTimer report_timer;
+    QObject::connect( &report_timer, &QTimer::timeout, [&]()
+    {
+        const uint64_t messages = generator.messagesSent();
+        const uint64_t transitions = generator.transitionsSent();
+        out << QString::number( clock.elapsed() * 0.001, 'f', 1 ) << " s: "
+            << (messages - last_messages) << " messages/s, "
+            << (transitions - last_transitions) << " transitions/s, "
+            << generator.messagesLate() << " late, "
+            << generator.treeRequests() << " tree requests" << endl;
+        last_messages = messages;
+        last_transitions = transitions;
+
+        if( duration > 0 && clock.elapsed() >= duration * 1000 )
+        {
+            app.quit();
+        }
+    });
+    report_timer.start( 1000 );
+
+    const int result = app.exec();
+    generator.stop();
+    return result;
+}
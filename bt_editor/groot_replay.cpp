@@ -0,0 +1,160 @@
+// groot-replay: analyze .fbl logs without the GUI.
+//
+// The logs are parsed in parallel by AnalyzeLog (fbl_report.h), with the same
+// code used by the replay panel (ParseFblLayout, TransitionDecoder, TransitionStats).
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include "fbl_report.h"
+
+// short human readable summary
+static void writeSummary(QTextStream& out, const LogReport& report)
+{
+    out << report.filename << ": ";
+    if( report.nodes.empty() )
+    {
+        out << "ERROR, " << report.error << "\n";
+        return;
+    }
+    out << report.transitions << " transitions, "
+        << QString::number(report.duration, 'f', 3) << " s";
+    if( !report.error.isEmpty() )
+    {
+        out << " (" << report.error << ")";
+    }
+    out << "\n";
+
+    std::vector<const NodeReport*> slowest;
+    for (const NodeReport& node: report.nodes)
+    {
+        slowest.push_back( &node );
+    }
+    std::sort( slowest.begin(), slowest.end(), [](const NodeReport* a, const NodeReport* b)
+    {
+        return a->summary.running_total > b->summary.running_total;
+    });
+
+    const size_t MAX_LISTED = 5;
+    for (size_t i = 0; i < std::min(MAX_LISTED, slowest.size()); i++)
+    {
+        const auto& summary = slowest[i]->summary;
+        if( summary.running_count == 0 )
+        {
+            break;
+        }
+        out << "  running " << QString::number(summary.running_total, 'f', 3) << " s"
+            << " (mean " << QString::number(summary.running_mean, 'f', 3)
+            << ", p95 " << QString::number(summary.running_p95, 'f', 3) << "): "
+            << slowest[i]->name << "\n";
+    }
+    for (const auto& it: report.failure_paths)
+    {
+        out << "  failed " << it.second << "x: " << it.first << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("groot-replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Per-node statistics and failure paths of BehaviorTree .fbl logs");
+    parser.addHelpOption();
+    parser.addPositionalArgument("logs", "The .fbl files to analyze", "<log.fbl>...");
+
+    QCommandLineOption jobs_option(QStringList() << "j" << "jobs",
+                                   "Number of logs analyzed in parallel (default: number of cores)",
+                                   "N");
+    parser.addOption(jobs_option);
+
+    QCommandLineOption csv_option(QStringList() << "csv",
+                                  "Write the statistics of each node as CSV ('-' for stdout)",
+                                  "file");
+    parser.addOption(csv_option);
+
+    QCommandLineOption json_option(QStringList() << "json",
+                                   "Write the statistics and the failure paths as JSON ('-' for stdout)",
+                                   "file");
+    parser.addOption(json_option);
+    parser.process( app );
+
+    const QStringList files = parser.positionalArguments();
+    if( files.empty() )
+    {
+        parser.showHelp(1);
+    }
+
+    if( parser.isSet(jobs_option) )
+    {
+        const int jobs = parser.value(jobs_option).toInt();
+        if( jobs <= 0 )
+        {
+            std::cerr << "wrong value passed to --jobs" << std::endl;
+            return 1;
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount( jobs );
+    }
+
+    const QList<LogReport> reports = QtConcurrent::blockingMapped( files, AnalyzeLog );
+
+    auto writeTo = [](const QString& filename, std::function<void(QTextStream&)> write)
+    {
+        QFile file;
+        bool opened = false;
+        if( filename == "-" )
+        {
+            opened = file.open(stdout, QIODevice::WriteOnly);
+        }
+        else{
+            file.setFileName(filename);
+            opened = file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+        }
+        if( !opened )
+        {
+            std::cerr << "can't write " << filename.toStdString() << std::endl;
+            return false;
+        }
+        QTextStream out(&file);
+        write( out );
+        return true;
+    };
+
+    bool ok = true;
+    const bool to_stdout = parser.value(csv_option) == "-" || parser.value(json_option) == "-";
+
+    if( !to_stdout )
+    {
+        QTextStream out(stdout);
+        for (const LogReport& report: reports)
+        {
+            writeSummary( out, report );
+        }
+    }
+
+    if( parser.isSet(csv_option) )
+    {
+        ok &= writeTo( parser.value(csv_option), [&](QTextStream& out){ WriteCsv(out, reports); } );
+    }
+    if( parser.isSet(json_option) )
+    {
+        ok &= writeTo( parser.value(json_option), [&](QTextStream& out){ out << ReportsToJson(reports).toJson(); } );
+    }
+
+    for (const LogReport& report: reports)
+    {
+        if( !report.error.isEmpty() )
+        {
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #include "interpreter_utils.h"
 #include "sidepanel_interpreter.h"
+#include <nodes/Node>
 
 using WsClient = SimpleWeb::SocketClient<SimpleWeb::WS>;
 
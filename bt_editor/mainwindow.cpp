@@ -3,6 +3,7 @@
 
 #include <QDebug>
 #include <QSettings>
+#include <QElapsedTimer>
 #include <QTextStream>
 #include <QList>
 #include <QMap>
@@ -46,6 +47,12 @@ MainWindow::MainWindow(GraphicMode initial_mode, QWidget *parent) :
 {
     ui->setupUi(this);
 
+    // at most one style pass per frame, whatever the rate of the status updates
+    _status_timer = new QTimer(this);
+    _status_timer->setSingleShot(true);
+    _status_timer->setInterval(16);
+    connect( _status_timer, &QTimer::timeout, this, &MainWindow::applyPendingStatus );
+
     QSettings settings;
     restoreGeometry(settings.value("MainWindow/geometry").toByteArray());
     restoreState(settings.value("MainWindow/windowState").toByteArray());
@@ -59,6 +66,8 @@ MainWindow::MainWindow(GraphicMode initial_mode, QWidget *parent) :
         _current_layout = QtNodes::PortLayout::Vertical;
     }
 
+    ui->actionPaint_only_nodes->setChecked( settings.value("MainWindow/paintOnlyNodes", false).toBool() );
+
     _model_registry = std::make_shared<QtNodes::DataModelRegistry>();
 
     //------------------------------------------------------
@@ -222,6 +231,9 @@ MainWindow::MainWindow(GraphicMode initial_mode, QWidget *parent) :
     connect( _replay_widget, &SidepanelReplay::changeNodeStyle,
             this, &MainWindow::onChangeNodesStatus);
 
+    connect( _replay_widget, &SidepanelReplay::changeNodeHeat,
+            this, &MainWindow::onChangeNodesHeat);
+
 #ifdef ZMQ_FOUND
 
     connect( _monitor_widget, &SidepanelMonitor::addNewModel,
@@ -1246,6 +1258,9 @@ void MainWindow::onCreateAbsBehaviorTree(const AbsBehaviorTree &tree,
         container = createTab(bt_name);
     }
     const QSignalBlocker blocker( container );
+    // the updates still pending refer to the previous tree
+    _pending_status.erase( bt_name );
+    _node_status.erase( bt_name );
     container->loadSceneFromTree( tree );
     container->nodeReorder();
 
@@ -1327,6 +1342,8 @@ void MainWindow::onActionClearTriggered(bool create_new)
         it.second->deleteLater();
     }
     _tab_info.clear();
+    _pending_status.clear();
+    _node_status.clear();
 
     ui->tabWidget->clear();
     if( create_new )
@@ -1557,8 +1574,7 @@ void MainWindow::on_actionEditor_mode_triggered()
     _interpreter_widget->clear();
     _replay_widget->clear();
 
-    auto tree = BuildTreeFromScene( currentTabInfo()->scene() );
-    resetTreeStyle(tree);
+    resetTreeStyle( currentTabInfo() );
 }
 
 void MainWindow::on_actionInterpreter_mode_triggered()
@@ -1665,62 +1681,209 @@ bool MainWindow::SavedState::operator ==(const MainWindow::SavedState &other) co
     return true;
 }
 
+void MainWindow::resetTreeStyle(GraphicContainer *container)
+{
+    applyPendingStatus();
+    for (const auto& it: _tab_info)
+    {
+        if( it.second == container )
+        {
+            resetNodesStyle( it.first, container->scene(), container->indexedNodes() );
+            return;
+        }
+    }
+}
+
+void MainWindow::resetNodesStyle(const QString& bt_name, QtNodes::FlowScene* scene,
+                                 const std::vector<GraphicContainer::IndexedNode> &nodes)
+{
+    _node_status.erase( bt_name );
+
+    auto heat_it = _node_heat.find( bt_name );
+    const std::vector<double>* node_heat = (heat_it != _node_heat.end()) ? &heat_it->second : nullptr;
+
+    scene->beginStyleUpdate();
+    for(size_t index = 0; index < nodes.size(); index++)
+    {
+        const auto& indexed = nodes[index];
+        const SharedStyle& style = node_heat ?
+                    getSharedStyleFromStatus( NodeStatus::IDLE, NodeStatus::IDLE,
+                                              index < node_heat->size() ? (*node_heat)[index] : 0.0 ) :
+                    getSharedDefaultStyle();
+        scene->setNodeStyle( *indexed.node, style.node );
+        if( indexed.connection_in )
+        {
+            scene->setConnectionStyle( *indexed.connection_in, style.connection );
+        }
+    }
+    scene->endStyleUpdate();
+}
+
 void MainWindow::resetTreeStyle(AbsBehaviorTree &tree){
     //printf("resetTreeStyle\n");
-    QtNodes::NodeStyle  node_style;
-    QtNodes::ConnectionStyle conn_style;
+    applyPendingStatus();
 
-    for(auto abs_node: tree.nodes()){
-        auto gui_node = abs_node.graphic_node;
+    if( tree.nodes().empty() )
+    {
+        return;
+    }
+    auto scene = static_cast<QtNodes::FlowScene*>(
+                tree.nodes().front().graphic_node->nodeGraphicsObject().scene() );
+    const SharedStyle& style = getSharedDefaultStyle();
 
-        gui_node->nodeDataModel()->setNodeStyle( node_style );
-        gui_node->nodeGraphicsObject().update();
+    scene->beginStyleUpdate();
+    for(const auto& abs_node: tree.nodes()){
+        auto gui_node = abs_node.graphic_node;
+        scene->setNodeStyle( *gui_node, style.node );
 
         const auto& conn_in = gui_node->nodeState().connections(PortType::In, 0 );
         if(conn_in.size() == 1)
         {
-            auto conn = conn_in.begin()->second;
-            conn->setStyle( conn_style );
-            conn->connectionGraphicsObject().update();
+            scene->setConnectionStyle( *conn_in.begin()->second, style.connection );
         }
     }
+    scene->endStyleUpdate();
 }
 
 void MainWindow::onChangeNodesStatus(const QString& bt_name,
                                      const std::vector<std::pair<int, NodeStatus> > &node_status,
                                      bool reset_before_update)
 {
-    auto tree = BuildTreeFromScene( getTabByName(bt_name)->scene() );
+    PendingStatus& pending = _pending_status[bt_name];
 
-    std::vector<NodeStatus> vec_last_status(tree.nodesCount());
-
-    // printf("---\n");
+    // the previous status of a node is the one of its preceding entry, if any
+    std::map<int, NodeStatus> last_status;
 
     for (auto& it: node_status)
     {
         const int index = it.first;
         const NodeStatus status = it.second;
-        auto& abs_node = tree.nodes().at(index);
 
-        // printf("%3d: %d, %s\n", index, (int)it.second, abs_node.instance_name.toStdString().c_str());
-        if(reset_before_update && index == 1 && it.second == NodeStatus::RUNNING)
-            resetTreeStyle(tree);
+        if(reset_before_update && index == 1 && status == NodeStatus::RUNNING)
+        {
+            pending.reset = true;
+            pending.nodes.clear();
+        }
 
-        auto gui_node = abs_node.graphic_node;
-        auto style = getStyleFromStatus( status, vec_last_status[index] );
-        gui_node->nodeDataModel()->setNodeStyle( style.first );
-        gui_node->nodeGraphicsObject().update();
+        auto last_it = last_status.find(index);
+        const NodeStatus prev_status = (last_it != last_status.end()) ? last_it->second : NodeStatus::IDLE;
+        pending.nodes[index] = { status, prev_status };
+        last_status[index] = status;
+    }
 
-        vec_last_status[index] = status;
+    if( !_status_timer->isActive() )
+    {
+        _status_timer->start();
+    }
+}
 
-        const auto& conn_in = gui_node->nodeState().connections(PortType::In, 0 );
-        if(conn_in.size() == 1)
+void MainWindow::applyPendingStatus()
+{
+    _status_timer->stop();
+
+    // a reset of the tree style below calls this again: it finds nothing to do
+    std::map<QString, PendingStatus> pending_status;
+    std::swap( pending_status, _pending_status );
+    if( pending_status.empty() )
+    {
+        return;
+    }
+    QElapsedTimer update_clock;
+    update_clock.start();
+
+    for (const auto& tab_it: pending_status)
+    {
+        const QString& bt_name = tab_it.first;
+        const PendingStatus& pending = tab_it.second;
+
+        auto container = getTabByName( bt_name );
+        if( !container )
+        {
+            continue;
+        }
+        // built again only if the scene changed: the cost is in the nodes that changed
+        const auto& nodes = container->indexedNodes();
+
+        // a node reset and then changed is invalidated once
+        auto scene = container->scene();
+        scene->beginStyleUpdate();
+
+        if( pending.reset )
+        {
+            resetNodesStyle( bt_name, scene, nodes );
+        }
+
+        auto heat_it = _node_heat.find( bt_name );
+        const std::vector<double>* node_heat = (heat_it != _node_heat.end()) ? &heat_it->second : nullptr;
+
+        auto& node_status = _node_status[bt_name];
+        node_status.resize( nodes.size(), { NodeStatus::IDLE, NodeStatus::IDLE } );
+
+        for (const auto& it: pending.nodes)
         {
-            auto conn = conn_in.begin()->second;
-            conn->setStyle( style.second );
-            conn->connectionGraphicsObject().update();
+            const int index = it.first;
+            if( index < 0 || index >= int(nodes.size()) )
+            {
+                continue;
+            }
+            auto gui_node = nodes[index].node;
+            node_status[index] = it.second;
+            const double heat = (node_heat && index < int(node_heat->size())) ? (*node_heat)[index] : 0.0;
+            // shared, not copied
+            const SharedStyle& style = getSharedStyleFromStatus( it.second.first, it.second.second, heat );
+            scene->setNodeStyle( *gui_node, style.node );
+
+            auto conn = nodes[index].connection_in;
+            if( conn )
+            {
+                scene->setConnectionStyle( *conn, style.connection );
+            }
         }
+        scene->endStyleUpdate();
+        _status_update_stats.nodes += pending.nodes.size();
+    }
+
+    const double update_time = update_clock.nsecsElapsed() * 1e-9;
+    _status_update_stats.frames++;
+    _status_update_stats.total_time += update_time;
+    _status_update_stats.max_time = std::max( _status_update_stats.max_time, update_time );
+}
+
+void MainWindow::onChangeNodesHeat(const QString& bt_name,
+                                   const std::vector<double>& node_heat)
+{
+    if( node_heat.empty() )
+    {
+        _node_heat.erase( bt_name );
+    }
+    else{
+        _node_heat[bt_name] = node_heat;
+    }
+
+    auto container = getTabByName( bt_name );
+    if( !container )
+    {
+        return;
+    }
+    // the pending status would be applied over the heat below
+    applyPendingStatus();
+
+    const auto& nodes = container->indexedNodes();
+    auto scene = container->scene();
+    const auto& node_status = _node_status[bt_name];
+
+    // shared, not allocated for each node at every refresh
+    scene->beginStyleUpdate();
+    for (size_t index = 0; index < nodes.size(); index++)
+    {
+        // a node never updated is IDLE; the heat does not change the connection
+        const auto status = index < node_status.size() ? node_status[index] :
+                                                         std::make_pair( NodeStatus::IDLE, NodeStatus::IDLE );
+        const double heat = index < node_heat.size() ? node_heat[index] : 0.0;
+        scene->setNodeStyle( *nodes[index].node,
+                             getSharedStyleFromStatus( status.first, status.second, heat ).node );
     }
+    scene->endStyleUpdate();
 }
 
 void MainWindow::onTabCustomContextMenuRequested(const QPoint &pos)
@@ -1869,6 +2032,13 @@ void MainWindow::on_actionReportIssue_triggered()
     QDesktopServices::openUrl(QUrl(url));
 }
 
+void MainWindow::on_actionPaint_only_nodes_toggled(bool checked)
+{
+    BehaviorTreeDataModel::setPaintOnly( checked );
+    QSettings settings;
+    settings.setValue("MainWindow/paintOnlyNodes", checked);
+}
+
 // returns the current graphic mode
 GraphicMode MainWindow::getGraphicMode(void) const
 {
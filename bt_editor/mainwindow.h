@@ -65,8 +65,11 @@ public:
 
     const NodeModels &registeredModels() const;
 
+    // the status updates not applied yet are applied first
     void resetTreeStyle(AbsBehaviorTree &tree);
 
+    void resetTreeStyle(GraphicContainer* container);
+
     GraphicMode getGraphicMode(void) const;
 
 public slots:
@@ -108,10 +111,18 @@ public slots:
                                  const QString &bt_name,
                                  bool secondary_tabs = true);
 
+    // Updates are merged and applied once per frame by applyPendingStatus()
     void onChangeNodesStatus(const QString& bt_name,
                              const std::vector<std::pair<int, NodeStatus>>& node_status,
                              bool reset_before_update);
 
+    void applyPendingStatus();
+
+    // heat in [0,1] for each node of bt_name, shown on top of the status.
+    // An empty vector removes the overlay.
+    void onChangeNodesHeat(const QString& bt_name,
+                           const std::vector<double>& node_heat);
+
     void on_toolButtonLayout_clicked();
 
     void on_actionEditor_mode_triggered();
@@ -144,6 +155,8 @@ private slots:
 
     void on_actionReportIssue_triggered();
 
+    void on_actionPaint_only_nodes_toggled(bool checked);
+
 public:
 
     void lockEditing(const bool locked, const bool selectable, const bool subtree_locked);
@@ -208,6 +221,37 @@ private:
 
     QString _main_tree;
 
+    std::map<QString, std::vector<double>> _node_heat;
+
+    // latest (status, previous status) of each node changed since the last frame
+    struct PendingStatus
+    {
+        bool reset = false;
+        std::map<int, std::pair<NodeStatus, NodeStatus>> nodes;
+    };
+    std::map<QString, PendingStatus> _pending_status;
+    QTimer* _status_timer;
+
+    // (status, previous status) shown by each node of a tab, to apply the heat to it
+    std::map<QString, std::vector<std::pair<NodeStatus, NodeStatus>>> _node_status;
+
+    // back to IDLE, keeping the heat of the tab if any
+    void resetNodesStyle(const QString& bt_name, QtNodes::FlowScene* scene,
+                         const std::vector<GraphicContainer::IndexedNode>& nodes);
+
+public:
+    // time spent restyling the scene in applyPendingStatus()
+    struct StatusUpdateStats{
+        uint64_t frames = 0;
+        uint64_t nodes = 0;
+        double total_time = 0;    // seconds
+        double max_time = 0;
+    };
+    const StatusUpdateStats& statusUpdateStats() const { return _status_update_stats; }
+
+private:
+    StatusUpdateStats _status_update_stats;
+
     SidepanelEditor* _editor_widget;
     SidepanelInterpreter* _interpreter_widget;
     SidepanelReplay* _replay_widget;
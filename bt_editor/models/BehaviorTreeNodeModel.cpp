@@ -3,27 +3,167 @@
 #include <QFormLayout>
 #include <QSizePolicy>
 #include <QLineEdit>
-#include <QComboBox>
 #include <QDebug>
 #include <QFile>
 #include <QFont>
 #include <QApplication>
 #include <QJsonDocument>
+#include <QPainter>
+#include <nodes/NodePainterDelegate>
 
 const int MARGIN = 10;
 const int DEFAULT_LINE_WIDTH  = 100;
 const int DEFAULT_FIELD_WIDTH = 50;
 const int DEFAULT_LABEL_WIDTH = 50;
 
+// layout of the painted content, close to the one of the widgets
+const int CAPTION_HEIGHT = 20;
+const int CAPTION_POINT_SIZE = 12;
+const int ICON_SIZE = 20;
+const int SPACING = 2;
+const int FORM_HORIZONTAL_SPACING = 4;
+
+static bool paint_only_nodes = false;
+
+namespace{
+
+// draws the content of the nodes that have no widgets
+class PaintedContentDelegate: public QtNodes::NodePainterDelegate
+{
+public:
+    void paint(QPainter* painter,
+               QtNodes::NodeGeometry const& geom,
+               NodeDataModel const * model) override
+    {
+        auto bt_model = static_cast<const BehaviorTreeDataModel*>( model );
+        bt_model->paintContent( painter, QRectF( geom.widgetPosition(), bt_model->paintedContentSize() ) );
+    }
+};
+
+QSvgRenderer* IconRenderer(const QString& icon, const QColor& color)
+{
+    // thousands of nodes, a handful of icons
+    static std::map<QString, QSvgRenderer*> renderers;
+    const QString key = icon + color.name();
+    auto it = renderers.find( key );
+    if( it != renderers.end() )
+    {
+        return it->second;
+    }
+
+    QSvgRenderer* renderer = nullptr;
+    QFile file(icon);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qDebug()<<"file not opened: "<< icon;
+    }
+    else {
+        QByteArray ba = file.readAll();
+        QByteArray new_color_fill = QString("fill:%1;").arg( color.name() ).toUtf8();
+        ba.replace("fill:#ffffff;", new_color_fill);
+        renderer = new QSvgRenderer(ba, qApp);
+    }
+    renderers.insert( std::make_pair(key, renderer) );
+    return renderer;
+}
+
+QStringRef StripPort(const QString& string_value)
+{
+    QStringRef str(&string_value);
+    if (str.startsWith('$')) {
+        str = str.mid(1);
+    }
+    if (str.startsWith('{') && str.endsWith('}')) {
+        str = str.mid(1, str.size()-2);
+    }
+    return str;
+}
+
+QFont CaptionFont()
+{
+    QFont capt_font;
+    capt_font.setPointSize(CAPTION_POINT_SIZE);
+    return capt_font;
+}
+
+}
+
 BehaviorTreeDataModel::BehaviorTreeDataModel(const NodeModel &model):
+    _main_widget(nullptr),
     _params_widget(nullptr),
+    _line_edit_name(nullptr),
     _uid( GetUID() ),
+    _form_layout(nullptr),
+    _main_layout(nullptr),
+    _caption_label(nullptr),
+    _caption_logo_left(nullptr),
+    _caption_logo_right(nullptr),
     _model(model),
     _icon_renderer(nullptr),
+    _paint_only( paint_only_nodes ),
+    _locked(false),
+    _instance_name_visible(true),
     _style_caption_color( QtNodes::NodeStyle().FontColor ),
     _style_caption_alias( model.registration_ID )
 {
     readStyle();
+    if( !_style_icon.isEmpty() )
+    {
+        _icon_renderer = IconRenderer( _style_icon, _style_caption_color );
+    }
+
+    PortDirection preferred_port_types[3] = { PortDirection::INPUT,
+                                              PortDirection::OUTPUT,
+                                              PortDirection::INOUT};
+
+    for(int pref_index=0; pref_index < 3; pref_index++)
+    {
+        for(const auto& port_it: model.ports )
+        {
+            if( port_it.second.required )
+            {
+                // Don't display required ports in the viewport
+                // Instead, force users to set default values
+                continue;
+            }
+            auto preferred_direction = preferred_port_types[pref_index];
+            if( port_it.second.direction != preferred_direction )
+            {
+                continue;
+            }
+
+            QString description = port_it.second.description;
+            QString label = port_it.first;
+            if( preferred_direction == PortDirection::INPUT)
+            {
+                label.prepend("[IN] ");
+                if( description.isEmpty())
+                {
+                    description="[INPUT]";
+                }
+                else{
+                    description.prepend("[INPUT]: ");
+                }
+            }
+            else if( preferred_direction == PortDirection::OUTPUT){
+                label.prepend("[OUT] ");
+                if( description.isEmpty())
+                {
+                    description="[OUTPUT]";
+                }
+                else{
+                    description.prepend("[OUTPUT]: ");
+                }
+            }
+
+            _port_rows.push_back( { port_it.first, label, description } );
+            _port_values.insert( std::make_pair( port_it.first, port_it.second.default_value ) );
+        }
+    }
+}
+
+void BehaviorTreeDataModel::buildWidgets()
+{
     _main_widget = new QFrame();
     _line_edit_name = new QLineEdit(_main_widget);
     _params_widget = new QFrame();
@@ -36,14 +176,14 @@ BehaviorTreeDataModel::BehaviorTreeDataModel(const NodeModel &model):
     _caption_label = new QLabel();
     _caption_logo_left  = new QFrame();
     _caption_logo_right = new QFrame();
-    _caption_logo_left->setFixedSize( QSize(0,20) );
-    _caption_logo_right->setFixedSize( QSize(0,20) );
-    _caption_label->setFixedHeight(20);
+    _caption_logo_left->setFixedSize( QSize(0,CAPTION_HEIGHT) );
+    _caption_logo_right->setFixedSize( QSize(0,CAPTION_HEIGHT) );
+    _caption_label->setFixedHeight(CAPTION_HEIGHT);
 
     _caption_logo_left->installEventFilter(this);
 
     QFont capt_font = _caption_label->font();
-    capt_font.setPointSize(12);
+    capt_font.setPointSize(CAPTION_POINT_SIZE);
     _caption_label->setFont(capt_font);
 
     capt_layout->addWidget(_caption_logo_left, 0, Qt::AlignRight);
@@ -54,12 +194,13 @@ BehaviorTreeDataModel::BehaviorTreeDataModel(const NodeModel &model):
     _main_layout->addWidget( _line_edit_name );
 
     _main_layout->setMargin(0);
-    _main_layout->setSpacing(2);
+    _main_layout->setSpacing(SPACING);
 
     //----------------------------
     _line_edit_name->setAlignment( Qt::AlignCenter );
     _line_edit_name->setText( _instance_name );
     _line_edit_name->setFixedWidth( DEFAULT_LINE_WIDTH );
+    _line_edit_name->setHidden( !_instance_name_visible );
 
     _main_widget->setAttribute(Qt::WA_NoSystemBackground);
 
@@ -74,97 +215,56 @@ BehaviorTreeDataModel::BehaviorTreeDataModel(const NodeModel &model):
     _main_layout->addWidget(_params_widget);
     _params_widget->setStyleSheet("color: white;");
 
-    _form_layout->setHorizontalSpacing(4);
-    _form_layout->setVerticalSpacing(2);
+    _form_layout->setHorizontalSpacing(FORM_HORIZONTAL_SPACING);
+    _form_layout->setVerticalSpacing(SPACING);
     _form_layout->setContentsMargins(0, 0, 0, 0);
 
-    PortDirection preferred_port_types[3] = { PortDirection::INPUT,
-                                              PortDirection::OUTPUT,
-                                              PortDirection::INOUT};
-
-    for(int pref_index=0; pref_index < 3; pref_index++)
+    for(const auto& row: _port_rows )
     {
-        for(const auto& port_it: model.ports )
-        {
-            if( port_it.second.required )
-            {
-                // Don't display required ports in the viewport
-                // Instead, force users to set default values
-                continue;
-            }
-            auto preferred_direction = preferred_port_types[pref_index];
-            if( port_it.second.direction != preferred_direction )
-            {
-                continue;
-            }
+        const QString port_name = row.name;
+        const QString label = row.label;
 
-            QString description = port_it.second.description;
-            QString label = port_it.first;
-            if( preferred_direction == PortDirection::INPUT)
-            {
-                label.prepend("[IN] ");
-                if( description.isEmpty())
-                {
-                    description="[INPUT]";
-                }
-                else{
-                    description.prepend("[INPUT]: ");
-                }
-            }
-            else if( preferred_direction == PortDirection::OUTPUT){
-                label.prepend("[OUT] ");
-                if( description.isEmpty())
-                {
-                    description="[OUTPUT]";
-                }
-                else{
-                    description.prepend("[OUTPUT]: ");
-                }
-            }
+        GrootLineEdit* form_field = new GrootLineEdit();
+        form_field->setAlignment( Qt::AlignHCenter);
+        form_field->setMaximumWidth(140);
+        form_field->setText( _port_values[port_name] );
 
-            GrootLineEdit* form_field = new GrootLineEdit();
-            form_field->setAlignment( Qt::AlignHCenter);
-            form_field->setMaximumWidth(140);
-            form_field->setText( port_it.second.default_value );
+        connect(form_field, &GrootLineEdit::doubleClicked,
+                this, [this,form_field]()
+                { emit this->portValueDoubleChicked(form_field); });
 
-            connect(form_field, &GrootLineEdit::doubleClicked,
-                    this, [this,form_field]()
-                    { emit this->portValueDoubleChicked(form_field); });
+        connect(form_field, &GrootLineEdit::lostFocus,
+                this, [this]()
+                { emit this->portValueDoubleChicked(nullptr); });
 
-            connect(form_field, &GrootLineEdit::lostFocus,
-                    this, [this]()
-                    { emit this->portValueDoubleChicked(nullptr); });
+        QLabel* form_label  =  new QLabel( label, _params_widget );
+        form_label->setStyleSheet("QToolTip {color: black;}");
+        form_label->setToolTip( row.description );
 
-            QLabel* form_label  =  new QLabel( label, _params_widget );
-            form_label->setStyleSheet("QToolTip {color: black;}");
-            form_label->setToolTip( description );
+        form_field->setMinimumWidth(DEFAULT_FIELD_WIDTH);
 
-            form_field->setMinimumWidth(DEFAULT_FIELD_WIDTH);
+        _ports_widgets.insert( std::make_pair( port_name, form_field) );
 
-            _ports_widgets.insert( std::make_pair( port_it.first, form_field) );
+        form_field->setStyleSheet("color: rgb(30,30,30); "
+                                  "background-color: rgb(200,200,200); "
+                                  "border: 0px; ");
 
-            form_field->setStyleSheet("color: rgb(30,30,30); "
-                                      "background-color: rgb(200,200,200); "
-                                      "border: 0px; ");
+        _form_layout->addRow( form_label, form_field );
 
-            _form_layout->addRow( form_label, form_field );
+        // the model holds the values, the widget only edits them
+        connect( form_field, &QLineEdit::textChanged, this, [this,port_name](const QString& text)
+        {
+            _port_values[port_name] = text;
+        });
 
-            auto paramUpdated = [this,label,form_field]()
-            {
-                this->parameterUpdated(label,form_field);
-            };
+        auto paramUpdated = [this,label,form_field]()
+        {
+            this->parameterUpdated(label,form_field);
+        };
 
-            if(auto lineedit = dynamic_cast<QLineEdit*>( form_field ) )
-            {
-                connect( lineedit, &QLineEdit::editingFinished, this, paramUpdated );
-                connect( lineedit, &QLineEdit::editingFinished,
-                         this, &BehaviorTreeDataModel::updateNodeSize);
-            }
-            else if( auto combo = dynamic_cast<QComboBox*>( form_field ) )
-            {
-                connect( combo, &QComboBox::currentTextChanged, this, paramUpdated);
-            }
-        }
+        connect( form_field, &QLineEdit::editingFinished, this, paramUpdated );
+        connect( form_field, &QLineEdit::editingFinished,
+                 this, &BehaviorTreeDataModel::updateNodeSize);
     }
     _params_widget->adjustSize();
 
@@ -177,6 +277,24 @@ BehaviorTreeDataModel::BehaviorTreeDataModel(const NodeModel &model):
     {
         setInstanceName( _line_edit_name->text() );
     });
+
+    //--------------------------------------
+    if( _style_icon.isEmpty() == false )
+    {
+        _caption_logo_left->setFixedWidth( ICON_SIZE );
+        _caption_logo_right->setFixedWidth( 1 );
+    }
+
+    _caption_label->setText( _style_caption_alias );
+
+    QPalette capt_palette = _caption_label->palette();
+    capt_palette.setColor(_caption_label->backgroundRole(), Qt::transparent);
+    capt_palette.setColor(_caption_label->foregroundRole(), _style_caption_color);
+    _caption_label->setPalette(capt_palette);
+
+    _caption_logo_left->adjustSize();
+    _caption_logo_right->adjustSize();
+    _caption_label->adjustSize();
 }
 
 BehaviorTreeDataModel::~BehaviorTreeDataModel()
@@ -184,6 +302,16 @@ BehaviorTreeDataModel::~BehaviorTreeDataModel()
 
 }
 
+void BehaviorTreeDataModel::setPaintOnly(bool paint_only)
+{
+    paint_only_nodes = paint_only;
+}
+
+bool BehaviorTreeDataModel::paintOnly()
+{
+    return paint_only_nodes;
+}
+
 NodeType BehaviorTreeDataModel::nodeType() const
 {
     return _model.type;
@@ -191,37 +319,50 @@ NodeType BehaviorTreeDataModel::nodeType() const
 
 void BehaviorTreeDataModel::initWidget()
 {
-    if( _style_icon.isEmpty() == false )
+    if( !_paint_only )
     {
-        _caption_logo_left->setFixedWidth( 20 );
-        _caption_logo_right->setFixedWidth( 1 );
+        createWidgets();
+    }
+    updateNodeSize();
+}
 
-        QFile file(_style_icon);
-        if(!file.open(QIODevice::ReadOnly))
-        {
-            qDebug()<<"file not opened: "<< _style_icon;
-            file.close();
-        }
-        else {
-            QByteArray ba = file.readAll();
-            QByteArray new_color_fill = QString("fill:%1;").arg( _style_caption_color.name() ).toUtf8();
-            ba.replace("fill:#ffffff;", new_color_fill);
-            _icon_renderer =  new QSvgRenderer(ba, this);
-        }
+void BehaviorTreeDataModel::createWidgets()
+{
+    if( _main_widget )
+    {
+        return;
     }
+    buildWidgets();
 
-    _caption_label->setText( _style_caption_alias );
+    lock( _locked );
+    onHighlightPortValue( _highlighted_value );
+    updateNodeSize();
 
-    QPalette capt_palette = _caption_label->palette();
-    capt_palette.setColor(_caption_label->backgroundRole(), Qt::transparent);
-    capt_palette.setColor(_caption_label->foregroundRole(), _style_caption_color);
-    _caption_label->setPalette(capt_palette);
+    emit embeddedWidgetChanged();
+}
 
-    _caption_logo_left->adjustSize();
-    _caption_logo_right->adjustSize();
-    _caption_label->adjustSize();
+void BehaviorTreeDataModel::requestEmbeddedWidget()
+{
+    // nothing to edit in a locked node
+    if( !_locked )
+    {
+        createWidgets();
+    }
+}
 
-    updateNodeSize();
+QtNodes::NodePainterDelegate *BehaviorTreeDataModel::painterDelegate() const
+{
+    static PaintedContentDelegate delegate;
+    return _main_widget ? nullptr : &delegate;
+}
+
+void BehaviorTreeDataModel::setInstanceNameVisible(bool visible)
+{
+    _instance_name_visible = visible;
+    if( _line_edit_name )
+    {
+        _line_edit_name->setHidden( !visible );
+    }
 }
 
 unsigned int BehaviorTreeDataModel::nPorts(QtNodes::PortType portType) const
@@ -255,6 +396,13 @@ NodeDataModel::ConnectionPolicy BehaviorTreeDataModel::portOutConnectionPolicy(Q
 
 void BehaviorTreeDataModel::updateNodeSize()
 {
+    if( !_main_widget )
+    {
+        updatePaintedSize();
+        emit embeddedWidgetSizeUpdated();
+        return;
+    }
+
     int caption_width = _caption_label->width();
     caption_width += _caption_logo_left->width() + _caption_logo_right->width();
     int line_edit_width =  caption_width;
@@ -310,6 +458,164 @@ void BehaviorTreeDataModel::updateNodeSize()
     emit embeddedWidgetSizeUpdated();
 }
 
+void BehaviorTreeDataModel::updatePaintedSize()
+{
+    // the same columns as updateNodeSize(), measured with the fonts of the widgets
+    const QFontMetrics fm( (QFont()) );
+    const QFontMetrics capt_fm( CaptionFont() );
+
+    int caption_width = capt_fm.boundingRect(_style_caption_alias).width();
+    if( _style_icon.isEmpty() == false )
+    {
+        caption_width += ICON_SIZE + 1;
+    }
+    int line_edit_width = caption_width;
+    int height = CAPTION_HEIGHT;
+
+    if( _instance_name_visible )
+    {
+        line_edit_width = std::max( line_edit_width, fm.boundingRect(_instance_name).width() + MARGIN );
+        height += SPACING + fm.height() + 2*SPACING;
+    }
+
+    int field_colum_width = DEFAULT_LABEL_WIDTH;
+    int label_colum_width = 0;
+    for(const auto& row: _port_rows)
+    {
+        const QString& value = _port_values.at(row.name);
+        field_colum_width = std::max( field_colum_width, fm.boundingRect(value).width() + MARGIN);
+        label_colum_width = std::max( label_colum_width, fm.boundingRect(row.label).width() );
+    }
+    if( !_port_rows.empty() )
+    {
+        field_colum_width = std::max( field_colum_width,
+                                      line_edit_width - label_colum_width - FORM_HORIZONTAL_SPACING);
+        line_edit_width = std::max( line_edit_width,
+                                    label_colum_width + FORM_HORIZONTAL_SPACING + field_colum_width );
+        height += SPACING + int(_port_rows.size()) * (fm.height() + 2*SPACING + SPACING) - SPACING;
+    }
+
+    const QString button_text = paintedButtonText();
+    if( !button_text.isEmpty() )
+    {
+        line_edit_width = std::max( line_edit_width, fm.boundingRect(button_text).width() + 4*SPACING );
+        height += SPACING + fm.height() + 4*SPACING;
+    }
+    _painted_size = QSize( line_edit_width, height );
+}
+
+void BehaviorTreeDataModel::paintContent(QPainter *painter, const QRectF &rect) const
+{
+    painter->save();
+
+    const QFont font;
+    const QFont capt_font = CaptionFont();
+    const QFontMetrics fm( font );
+    const QFontMetrics capt_fm( capt_font );
+    double y = rect.top();
+
+    // caption, with the icon at its left
+    {
+        double caption_width = capt_fm.boundingRect(_style_caption_alias).width();
+        double icon_width = _style_icon.isEmpty() ? 0 : ICON_SIZE + 1;
+        double x = rect.left() + (rect.width() - caption_width - icon_width) * 0.5;
+        if( _icon_renderer )
+        {
+            _icon_renderer->render( painter, QRectF( x, y, ICON_SIZE, ICON_SIZE ) );
+        }
+        painter->setFont( capt_font );
+        painter->setPen( _style_caption_color );
+        painter->drawText( QRectF( x + icon_width, y, caption_width, CAPTION_HEIGHT ),
+                           Qt::AlignCenter, _style_caption_alias );
+        y += CAPTION_HEIGHT;
+    }
+    painter->setFont( font );
+
+    if( _instance_name_visible )
+    {
+        y += SPACING;
+        const double line_height = fm.height() + 2*SPACING;
+        painter->setPen( Qt::white );
+        painter->drawText( QRectF( rect.left(), y, rect.width(), line_height ),
+                           Qt::AlignCenter, _instance_name );
+        y += line_height;
+    }
+
+    if( !_port_rows.empty() )
+    {
+        int label_colum_width = 0;
+        for(const auto& row: _port_rows)
+        {
+            label_colum_width = std::max( label_colum_width, fm.boundingRect(row.label).width() );
+        }
+        const double field_x = rect.left() + label_colum_width + FORM_HORIZONTAL_SPACING;
+        const double field_width = rect.right() - field_x;
+        const double row_height = fm.height() + 2*SPACING;
+
+        for(const auto& row: _port_rows)
+        {
+            y += SPACING;
+            const QString& value = _port_values.at(row.name);
+            painter->setPen( Qt::white );
+            painter->drawText( QRectF( rect.left(), y, label_colum_width, row_height ),
+                               Qt::AlignLeft | Qt::AlignVCenter, row.label );
+
+            const QRectF field( field_x, y, field_width, row_height );
+            painter->fillRect( field, isHighlighted(value) ? QColor("#ffef0b") : QColor(200,200,200) );
+            painter->setPen( QColor(30,30,30) );
+            painter->drawText( field, Qt::AlignCenter, value );
+            y += row_height;
+        }
+    }
+
+    const QRectF button = paintedButtonRect( rect );
+    if( !button.isEmpty() )
+    {
+        // the colors of the style sheet of the button
+        const bool enabled = paintedButtonEnabled();
+        painter->setPen( Qt::NoPen );
+        painter->setBrush( enabled ? QColor(Qt::white) : QColor("#a0a0a0") );
+        painter->drawRoundedRect( button, 3, 3 );
+        painter->setPen( enabled ? QColor(Qt::black) : QColor("#303030") );
+        painter->drawText( button, Qt::AlignCenter, paintedButtonText() );
+    }
+
+    painter->restore();
+}
+
+QRectF BehaviorTreeDataModel::paintedButtonRect(const QRectF &rect) const
+{
+    const QString button_text = paintedButtonText();
+    if( button_text.isEmpty() )
+    {
+        return QRectF();
+    }
+    // below the rows drawn by paintContent()
+    const QFontMetrics fm( (QFont()) );
+    double y = rect.top() + CAPTION_HEIGHT;
+    if( _instance_name_visible )
+    {
+        y += SPACING + fm.height() + 2*SPACING;
+    }
+    y += double(_port_rows.size()) * (SPACING + fm.height() + 2*SPACING);
+    y += SPACING;
+
+    const double button_width = std::min( 100, fm.boundingRect(button_text).width() + 4*SPACING );
+    return QRectF( rect.left() + (rect.width() - button_width) * 0.5, y,
+                   button_width, fm.height() + 4*SPACING );
+}
+
+bool BehaviorTreeDataModel::paintedContentPressed(const QPointF &pos)
+{
+    const QRectF button = paintedButtonRect( QRectF( QPointF(), _painted_size ) );
+    if( button.isEmpty() || !button.contains( pos ) || !paintedButtonEnabled() )
+    {
+        return false;
+    }
+    paintedButtonPressed();
+    return true;
+}
+
 QtNodes::NodeDataType BehaviorTreeDataModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const
 {
     return NodeDataType {"", ""};
@@ -322,32 +628,37 @@ std::shared_ptr<QtNodes::NodeData> BehaviorTreeDataModel::outData(QtNodes::PortI
 
 void BehaviorTreeDataModel::readStyle()
 {
-    QFile style_file(":/NodesStyle.json");
-
-    if (!style_file.open(QIODevice::ReadOnly))
+    // the same for every node
+    static const QJsonObject toplevel_object = []()
     {
-        qWarning("Couldn't open NodesStyle.json");
-        return;
-    }
+        QFile style_file(":/NodesStyle.json");
 
-    QByteArray bytearray =  style_file.readAll();
-    style_file.close();
-    QJsonParseError error;
-    QJsonDocument json_doc( QJsonDocument::fromJson( bytearray, &error ));
+        if (!style_file.open(QIODevice::ReadOnly))
+        {
+            qWarning("Couldn't open NodesStyle.json");
+            return QJsonObject();
+        }
 
-    if(json_doc.isNull()){
-        qDebug()<<"Failed to create JSON doc: " << error.errorString();
-        return;
-    }
-    if(!json_doc.isObject()){
-        qDebug()<<"JSON is not an object.";
-        return;
-    }
+        QByteArray bytearray =  style_file.readAll();
+        style_file.close();
+        QJsonParseError error;
+        QJsonDocument json_doc( QJsonDocument::fromJson( bytearray, &error ));
 
-    QJsonObject toplevel_object = json_doc.object();
+        if(json_doc.isNull()){
+            qDebug()<<"Failed to create JSON doc: " << error.errorString();
+            return QJsonObject();
+        }
+        if(!json_doc.isObject()){
+            qDebug()<<"JSON is not an object.";
+            return QJsonObject();
+        }
+        if(json_doc.object().isEmpty()){
+            qDebug()<<"JSON object is empty.";
+        }
+        return json_doc.object();
+    }();
 
     if(toplevel_object.isEmpty()){
-        qDebug()<<"JSON object is empty.";
         return;
     }
     QString model_type_name( QString::fromStdString(toStr(_model.type)) );
@@ -378,6 +689,11 @@ const QString& BehaviorTreeDataModel::registrationName() const
     return _model.registration_ID;
 }
 
+QString BehaviorTreeDataModel::caption() const
+{
+    return _instance_name.isEmpty() ? _style_caption_alias : _instance_name;
+}
+
 const QString &BehaviorTreeDataModel::instanceName() const
 {
     return _instance_name;
@@ -385,23 +701,7 @@ const QString &BehaviorTreeDataModel::instanceName() const
 
 PortsMapping BehaviorTreeDataModel::getCurrentPortMapping() const
 {
-    PortsMapping out;
-
-    for(const auto& it: _ports_widgets)
-    {
-        const auto& label = it.first;
-        const auto& value = it.second;
-
-        if(auto linedit = dynamic_cast<QLineEdit*>( value ) )
-        {
-            out.insert( std::make_pair( label, linedit->text() ) );
-        }
-        else if( auto combo = dynamic_cast<QComboBox*>( value ) )
-        {
-            out.insert( std::make_pair( label, combo->currentText() ) );
-        }
-    }
-    return out;
+    return _port_values;
 }
 
 QJsonObject BehaviorTreeDataModel::save() const
@@ -410,14 +710,9 @@ QJsonObject BehaviorTreeDataModel::save() const
     modelJson["name"]  = registrationName();
     modelJson["alias"] = instanceName();
 
-    for (const auto& it: _ports_widgets)
+    for (const auto& it: _port_values)
     {
-        if( auto linedit = dynamic_cast<QLineEdit*>(it.second)){
-            modelJson[it.first] = linedit->text();
-        }
-        else if( auto combo = dynamic_cast<QComboBox*>(it.second)){
-            modelJson[it.first] = combo->currentText();
-        }
+        modelJson[it.first] = it.second;
     }
 
     return modelJson;
@@ -444,41 +739,32 @@ void BehaviorTreeDataModel::restore(const QJsonObject &modelJson)
 
 void BehaviorTreeDataModel::lock(bool locked)
 {
+    _locked = locked;
+    if( !_main_widget )
+    {
+        return;
+    }
     _line_edit_name->setEnabled( !locked );
 
     for(const auto& it: _ports_widgets)
     {
-        const auto& field_widget = it.second;
-
-        if(auto lineedit = dynamic_cast<QLineEdit*>( field_widget  ))
-        {
-            lineedit->setReadOnly( locked );
-        }
-        else if(auto combo = dynamic_cast<QComboBox*>( field_widget ))
-        {
-            combo->setEnabled( !locked );
-        }
+        it.second->setReadOnly( locked );
     }
 }
 
 void BehaviorTreeDataModel::setPortMapping(const QString &port_name, const QString &value)
 {
-    auto it = _ports_widgets.find(port_name);
-    if( it != _ports_widgets.end() )
+    auto it = _port_values.find(port_name);
+    if( it != _port_values.end() )
     {
-        if( auto lineedit = dynamic_cast<QLineEdit*>(it->second) )
+        it->second = value;
+        auto widget_it = _ports_widgets.find(port_name);
+        if( widget_it != _ports_widgets.end() )
         {
-            lineedit->setText(value);
+            widget_it->second->setText(value);
         }
-        else if( auto combo = dynamic_cast<QComboBox*>(it->second) )
-        {
-            int index = combo->findText(value);
-            if( index == -1 ){
-                qDebug() << "error, combo value "<< value << " not found";
-            }
-            else{
-                combo->setCurrentIndex(index);
-            }
+        else{
+            updateNodeSize();
         }
     }
     else{
@@ -500,46 +786,61 @@ bool BehaviorTreeDataModel::eventFilter(QObject *obj, QEvent *event)
 void BehaviorTreeDataModel::setInstanceName(const QString &name)
 {
     _instance_name = name;
-    _line_edit_name->setText( name );
+    if( _line_edit_name )
+    {
+        _line_edit_name->setText( name );
+    }
 
     updateNodeSize();
     emit instanceNameChanged();
 }
 
-
-void BehaviorTreeDataModel::onHighlightPortValue(QString value)
+bool BehaviorTreeDataModel::isHighlighted(const QString &port_value) const
 {
     // highlight both port names and value references
     // e.g. {var} ${var} $var var
-    auto strip_port = [](const QString& string_value) {
-        QStringRef str(&string_value);
-        if (str.startsWith('$')) {
-            str = str.mid(1);
-        }
-        if (str.startsWith('{') && str.endsWith('}')) {
-            str = str.mid(1, str.size()-2);
-        }
-        return str;
-    };
+    const QStringRef ref_value = StripPort(_highlighted_value);
+    return !ref_value.isEmpty() && StripPort(port_value) == ref_value;
+}
+
+void BehaviorTreeDataModel::onHighlightPortValue(QString value)
+{
+    bool changed = false;
+    std::vector<bool> was_highlighted;
+    for( const auto& it: _port_values )
+    {
+        was_highlighted.push_back( isHighlighted(it.second) );
+    }
+    _highlighted_value = value;
 
-    auto ref_value = strip_port(value);
-    for( const auto& it:  _ports_widgets)
+    size_t index = 0;
+    for( const auto& it: _port_values )
     {
-        if( auto line_edit = dynamic_cast<QLineEdit*>(it.second) )
+        const bool highlighted = isHighlighted(it.second);
+        changed = changed || (highlighted != was_highlighted[index++]);
+
+        auto widget_it = _ports_widgets.find(it.first);
+        if( widget_it == _ports_widgets.end() )
         {
-            QString line_str = line_edit->text();
-            if( !ref_value.isEmpty() && strip_port(line_str) == ref_value )
-            {
-                line_edit->setStyleSheet("color: rgb(30,30,30); "
-                                         "background-color: #ffef0b; "
-                                         "border: 0px; ");
-            }
-            else{
-                line_edit->setStyleSheet("color: rgb(30,30,30); "
-                                         "background-color: rgb(200,200,200); "
-                                         "border: 0px; ");
-            }
+            continue;
         }
+        if( highlighted )
+        {
+            widget_it->second->setStyleSheet("color: rgb(30,30,30); "
+                                             "background-color: #ffef0b; "
+                                             "border: 0px; ");
+        }
+        else{
+            widget_it->second->setStyleSheet("color: rgb(30,30,30); "
+                                             "background-color: rgb(200,200,200); "
+                                             "border: 0px; ");
+        }
+    }
+
+    // a painted node is drawn again only if its highlight changed
+    if( changed && !_main_widget )
+    {
+        emit embeddedWidgetSizeUpdated();
     }
 }
 
@@ -37,10 +37,20 @@ public:
 
     virtual void setInstanceName(const QString& name);
 
+    // Nodes created afterwards draw their content with the NodePainter, and
+    // create their editor widgets only when the user is about to edit them.
+    // Much faster to load and lighter for large trees.
+    static void setPaintOnly(bool paint_only);
+
+    static bool paintOnly();
+
 public:
 
     void initWidget();
 
+    // the editor widgets, if they don't exist yet
+    void createWidgets();
+
     virtual unsigned int nPorts(PortType portType) const override;
 
     ConnectionPolicy portOutConnectionPolicy(PortIndex) const final;
@@ -57,14 +67,28 @@ public:
 
     QString name() const final { return registrationName(); }
 
+    QString caption() const override;
+
     const QString& instanceName() const;
 
     PortsMapping getCurrentPortMapping() const;
 
+    // nullptr in paint-only mode, until createWidgets()
     QWidget *embeddedWidget() final { return _main_widget; }
 
     QWidget *parametersWidget() { return _params_widget; }
 
+    QSize paintedContentSize() const final { return _painted_size; }
+
+    void requestEmbeddedWidget() override;
+
+    bool paintedContentPressed(QPointF const& pos) final;
+
+    QtNodes::NodePainterDelegate* painterDelegate() const final;
+
+    // what the widgets would show, drawn in rect
+    void paintContent(QPainter* painter, const QRectF& rect) const;
+
     QJsonObject save() const override;
 
     void restore(QJsonObject const &) override;
@@ -86,12 +110,25 @@ public slots:
 
 protected:
 
+    // add to the widgets of the base class
+    virtual void buildWidgets();
+
+    void setInstanceNameVisible(bool visible);
+
+    // a button drawn below the ports in paint-only mode, if not empty
+    virtual QString paintedButtonText() const { return QString(); }
+
+    virtual bool paintedButtonEnabled() const { return true; }
+
+    // the painted button has been clicked, even in a locked node
+    virtual void paintedButtonPressed() {}
+
     QFrame*  _main_widget;
     QFrame*  _params_widget;
 
     QLineEdit* _line_edit_name;
 
-    std::map<QString, QWidget*> _ports_widgets;
+    std::map<QString, QLineEdit*> _ports_widgets;
     int16_t _uid;
 
     QFormLayout* _form_layout;
@@ -103,13 +140,37 @@ protected:
 private:
     const NodeModel _model;
     QString _instance_name;
+    // shared by the nodes with the same icon and color
     QSvgRenderer* _icon_renderer;
 
+    // the ports shown in the node, in order, and their values
+    struct PortRow
+    {
+        QString name;
+        QString label;
+        QString description;
+    };
+    std::vector<PortRow> _port_rows;
+    PortsMapping _port_values;
+
+    bool _paint_only;
+    bool _locked;
+    bool _instance_name_visible;
+    QString _highlighted_value;
+    QSize _painted_size;
+
     void readStyle();
     QString _style_icon;
     QColor  _style_caption_color;
     QString  _style_caption_alias;
 
+    bool isHighlighted(const QString& port_value) const;
+
+    void updatePaintedSize();
+
+    // where paintContent() draws the button, if any
+    QRectF paintedButtonRect(const QRectF& rect) const;
+
 signals:
 
     void parameterUpdated(QString, QWidget*);
@@ -5,7 +5,7 @@
 RootNodeModel::RootNodeModel():
     BehaviorTreeDataModel ( NodeModel() )
 {
-    _line_edit_name->setHidden(true);
+    setInstanceNameVisible(false);
 }
 
 unsigned int RootNodeModel::nPorts(QtNodes::PortType portType) const
@@ -4,10 +4,18 @@
 
 SubtreeNodeModel::SubtreeNodeModel(const NodeModel &model):
     BehaviorTreeDataModel ( model ),
-    _expanded(false)
+    _expand_button(nullptr),
+    _expanded(false),
+    _expand_button_visible(true),
+    _expand_button_enabled(true)
 {
+    setInstanceNameVisible(false);
+}
+
+void SubtreeNodeModel::buildWidgets()
+{
+    BehaviorTreeDataModel::buildWidgets();
     _line_edit_name->setReadOnly(true);
-    _line_edit_name->setHidden(true);
 
     _expand_button = new QPushButton( _expanded ? "Collapse" : "Expand", _main_widget );
     _expand_button->setMaximumWidth(100);
@@ -22,6 +30,8 @@ SubtreeNodeModel::SubtreeNodeModel(const NodeModel &model):
                 "QPushButton:disabled { color: #303030; background-color: #a0a0a0; }");
     _expand_button->setFlat(false);
     _expand_button->setFocusPolicy(Qt::NoFocus);
+    _expand_button->setHidden( !_expand_button_visible );
+    _expand_button->setEnabled( _expand_button_enabled );
     _expand_button->adjustSize();
 
     connect( _expand_button, &QPushButton::clicked,
@@ -29,21 +39,64 @@ SubtreeNodeModel::SubtreeNodeModel(const NodeModel &model):
     {
         emit expandButtonPushed() ;
     });
+}
+
+QString SubtreeNodeModel::paintedButtonText() const
+{
+    if( !_expand_button_visible )
+    {
+        return QString();
+    }
+    return _expanded ? "Collapse" : "Expand";
+}
 
-    updateNodeSize();
+void SubtreeNodeModel::paintedButtonPressed()
+{
+    // from now on, the real button takes the clicks
+    createWidgets();
+    emit expandButtonPushed();
 }
 
 void SubtreeNodeModel::setExpanded(bool expand)
 {
     _expanded = expand;
+    if( !_expand_button )
+    {
+        updateNodeSize();
+        return;
+    }
     _expand_button->setText( _expanded ? "Collapse" : "Expand");
     _expand_button->adjustSize();
     _main_widget->adjustSize();
 }
 
+void SubtreeNodeModel::setExpandButtonVisible(bool visible)
+{
+    _expand_button_visible = visible;
+    if( _expand_button )
+    {
+        _expand_button->setHidden( !visible );
+    }
+    else{
+        updateNodeSize();
+    }
+}
+
+void SubtreeNodeModel::setExpandButtonEnabled(bool enabled)
+{
+    _expand_button_enabled = enabled;
+    if( _expand_button )
+    {
+        _expand_button->setEnabled( enabled );
+    }
+    else{
+        emit embeddedWidgetSizeUpdated();
+    }
+}
+
 void SubtreeNodeModel::setInstanceName(const QString &name)
 {
-    _line_edit_name->setHidden( name == registrationName() );
+    setInstanceNameVisible( name != registrationName() );
     BehaviorTreeDataModel::setInstanceName(name);
 }
 
@@ -27,8 +27,13 @@ public:
 
     static const char* Name() { return "SubTree";  }
 
+    // nullptr while the node is painted
     QPushButton* expandButton() { return _expand_button; }
 
+    void setExpandButtonVisible(bool visible);
+
+    void setExpandButtonEnabled(bool enabled);
+
     virtual void setInstanceName(const QString& name) override;
 
     QJsonObject save() const override;
@@ -38,9 +43,21 @@ public:
 signals:
     void expandButtonPushed();
 
+protected:
+    void buildWidgets() override;
+
+    QString paintedButtonText() const override;
+
+    bool paintedButtonEnabled() const override { return _expand_button_enabled; }
+
+    // the expand button can be used in a locked tree too
+    void paintedButtonPressed() override;
+
 private:
     QPushButton* _expand_button;
     bool _expanded;
+    bool _expand_button_visible;
+    bool _expand_button_enabled;
 
 };
 
@@ -0,0 +1,216 @@
+#include "monitor_load_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+
+MonitorLoadGenerator::MonitorLoadGenerator(zmq::context_t &context, const Options &options):
+    _context( context ),
+    _options( options ),
+    _random( options.seed ),
+    _running( false ),
+    _messages_sent( 0 ),
+    _transitions_sent( 0 ),
+    _tree_requests( 0 ),
+    _messages_late( 0 )
+{
+    _tree = _factory.createTreeFromText( treeXML( _options.nodes, _options.fanout ) );
+
+    // the reply of BT::PublisherZMQ to a tree request
+    flatbuffers::FlatBufferBuilder builder(1024);
+    BT::CreateFlatbuffersBehaviorTree( builder, _tree );
+    const char* buffer = reinterpret_cast<const char*>( builder.GetBufferPointer() );
+    _tree_buffer.assign( buffer, buffer + builder.GetSize() );
+
+    for (const auto& node: _tree.nodes)
+    {
+        _uids.push_back( node->UID() );
+        _status.push_back( BT::NodeStatus::IDLE );
+    }
+}
+
+MonitorLoadGenerator::~MonitorLoadGenerator()
+{
+    stop();
+}
+
+std::string MonitorLoadGenerator::treeXML(int nodes, int fanout)
+{
+    // node i is the parent of the nodes [i*fanout + 1, i*fanout + fanout]
+    std::ostringstream xml;
+    std::function<void(int, int)> writeNode = [&](int index, int depth)
+    {
+        const std::string indent( size_t(2 * depth), ' ' );
+        const int first_child = index * fanout + 1;
+        if( first_child >= nodes )
+        {
+            xml << indent << "<AlwaysSuccess name=\"node_" << index << "\"/>\n";
+            return;
+        }
+        xml << indent << "<Sequence name=\"node_" << index << "\">\n";
+        for (int child = first_child; child < first_child + fanout && child < nodes; child++)
+        {
+            writeNode( child, depth + 1 );
+        }
+        xml << indent << "</Sequence>\n";
+    };
+
+    xml << "<root main_tree_to_execute=\"MainTree\">\n"
+        << " <BehaviorTree ID=\"MainTree\">\n";
+    writeNode( 0, 2 );
+    xml << " </BehaviorTree>\n"
+        << "</root>\n";
+    return xml.str();
+}
+
+bool MonitorLoadGenerator::start(std::string *error)
+{
+    stop();
+    try{
+        // nothing to deliver once stopped
+        int linger_ms = 0;
+        _publisher.reset( new zmq::socket_t( _context, ZMQ_PUB ) );
+        _publisher->setsockopt( ZMQ_LINGER, &linger_ms, sizeof(int) );
+        _publisher->bind( ("tcp://*:" + std::to_string(_options.publisher_port)).c_str() );
+
+        _server.reset( new zmq::socket_t( _context, ZMQ_REP ) );
+        _server->setsockopt( ZMQ_LINGER, &linger_ms, sizeof(int) );
+        _server->bind( ("tcp://*:" + std::to_string(_options.server_port)).c_str() );
+    }
+    catch( zmq::error_t& err )
+    {
+        *error = err.what();
+        _publisher.reset();
+        _server.reset();
+        return false;
+    }
+
+    // from now on, each socket is used only by its own thread
+    _running = true;
+    _server_thread = std::thread( &MonitorLoadGenerator::runServer, this );
+    _publisher_thread = std::thread( &MonitorLoadGenerator::runPublisher, this );
+    return true;
+}
+
+void MonitorLoadGenerator::stop()
+{
+    _running = false;
+    if( _server_thread.joinable() )
+    {
+        _server_thread.join();
+    }
+    if( _publisher_thread.joinable() )
+    {
+        _publisher_thread.join();
+    }
+    _publisher.reset();
+    _server.reset();
+}
+
+void MonitorLoadGenerator::runServer()
+{
+    zmq::pollitem_t items[] = { { static_cast<void*>(*_server), 0, ZMQ_POLLIN, 0 } };
+    while( _running )
+    {
+        try{
+            zmq::poll( items, 1, 100 );
+            if( !(items[0].revents & ZMQ_POLLIN) )
+            {
+                continue;
+            }
+            zmq::message_t request;
+            _server->recv( &request );
+
+            zmq::message_t reply( _tree_buffer.data(), _tree_buffer.size() );
+            _server->send( reply );
+            _tree_requests++;
+        }
+        catch( zmq::error_t& )
+        {
+            break;
+        }
+    }
+}
+
+void MonitorLoadGenerator::runPublisher()
+{
+    using namespace std::chrono;
+    const auto period = duration_cast<steady_clock::duration>(
+                duration<double>( 1.0 / std::max( _options.messages_rate, 0.001 ) ) );
+    auto next_message = steady_clock::now();
+
+    while( _running )
+    {
+        createMessage( _options.transitions_per_message );
+        zmq::message_t message( _message.data(), _message.size() );
+        try{
+            // a PUB socket drops the messages that the subscribers can't take
+            _publisher->send( message );
+        }
+        catch( zmq::error_t& )
+        {
+            break;
+        }
+        _messages_sent++;
+        _transitions_sent += uint64_t(_options.transitions_per_message);
+
+        next_message += period;
+        const auto now = steady_clock::now();
+        if( next_message < now )
+        {
+            // don't try to catch up with a burst
+            _messages_late++;
+            next_message = now;
+        }
+        else{
+            std::this_thread::sleep_until( next_message );
+        }
+    }
+}
+
+void MonitorLoadGenerator::createMessage(int count)
+{
+    // | header size | (uid, status) per node | transitions count | transitions |,
+    // like the messages of BT::PublisherZMQ
+    const size_t nodes_count = _uids.size();
+    const size_t header_size = 3 * nodes_count;
+    const size_t transitions_offset = 4 + header_size + 4;
+    _message.resize( transitions_offset + size_t(count) * 12 );
+
+    const auto timestamp = std::chrono::duration_cast<BT::Duration>(
+                std::chrono::system_clock::now().time_since_epoch() );
+    std::uniform_int_distribution<size_t> random_node( 0, nodes_count - 1 );
+    std::bernoulli_distribution random_failure( 0.1 );
+
+    for (int i = 0; i < count; i++)
+    {
+        const size_t index = random_node( _random );
+        const BT::NodeStatus prev_status = _status[index];
+        BT::NodeStatus status = BT::NodeStatus::IDLE;
+        if( prev_status == BT::NodeStatus::IDLE )
+        {
+            status = BT::NodeStatus::RUNNING;
+        }
+        else if( prev_status == BT::NodeStatus::RUNNING )
+        {
+            status = random_failure( _random ) ? BT::NodeStatus::FAILURE : BT::NodeStatus::SUCCESS;
+        }
+        _status[index] = status;
+
+        const auto transition = BT::SerializeTransition( _uids[index], timestamp, prev_status, status );
+        std::copy( transition.begin(), transition.end(), &_message[transitions_offset + size_t(i) * 12] );
+    }
+
+    char* data = _message.data();
+    flatbuffers::WriteScalar<uint32_t>( data, static_cast<uint32_t>(header_size) );
+    data += 4;
+    for (size_t index = 0; index < nodes_count; index++)
+    {
+        flatbuffers::WriteScalar<uint16_t>( data, _uids[index] );
+        flatbuffers::WriteScalar<int8_t>( data + 2, static_cast<int8_t>( BT::convertToFlatbuffers(_status[index]) ) );
+        data += 3;
+    }
+    flatbuffers::WriteScalar<uint32_t>( data, static_cast<uint32_t>(count) );
+}
@@ -0,0 +1,89 @@
+#ifndef MONITOR_LOAD_GENERATOR_H
+#define MONITOR_LOAD_GENERATOR_H
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+#include <behaviortree_cpp_v3/bt_factory.h>
+
+// Stands in for a robot running BT::PublisherZMQ, to benchmark the monitor
+// without one: a synthetic tree is served over REQ/REP and random status
+// changes are published over PUB, in the same formats.
+class MonitorLoadGenerator
+{
+public:
+    struct Options{
+        int nodes = 100;                  // nodes of the tree (Groot adds its own root)
+        int fanout = 4;                   // children of each control node
+        double messages_rate = 100;       // messages per second
+        int transitions_per_message = 10;
+        int publisher_port = 1666;
+        int server_port = 1667;
+        unsigned seed = 0;
+    };
+
+    MonitorLoadGenerator(zmq::context_t& context, const Options& options);
+
+    ~MonitorLoadGenerator();
+
+    // bind the sockets and start the threads; false if a port can't be bound
+    bool start(std::string* error);
+
+    void stop();
+
+    bool isRunning() const { return _running; }
+
+    const Options& options() const { return _options; }
+
+    uint64_t messagesSent() const { return _messages_sent; }
+
+    uint64_t transitionsSent() const { return _transitions_sent; }
+
+    uint64_t treeRequests() const { return _tree_requests; }
+
+    // messages that could not be sent on time: the rate is too high for this machine
+    uint64_t messagesLate() const { return _messages_late; }
+
+    // a balanced tree of Sequences with AlwaysSuccess leaves
+    static std::string treeXML(int nodes, int fanout);
+
+private:
+    void runServer();
+
+    void runPublisher();
+
+    // apply count random transitions and write the message in _message
+    void createMessage(int count);
+
+    zmq::context_t& _context;
+    Options _options;
+
+    BT::BehaviorTreeFactory _factory;
+    BT::Tree _tree;
+    std::vector<char> _tree_buffer;
+
+    // per node of _tree
+    std::vector<uint16_t> _uids;
+    std::vector<BT::NodeStatus> _status;
+    std::mt19937 _random;
+
+    std::vector<char> _message;
+
+    std::unique_ptr<zmq::socket_t> _publisher;
+    std::unique_ptr<zmq::socket_t> _server;
+
+    std::atomic<bool> _running;
+    std::thread _server_thread;
+    std::thread _publisher_thread;
+
+    std::atomic<uint64_t> _messages_sent;
+    std::atomic<uint64_t> _transitions_sent;
+    std::atomic<uint64_t> _tree_requests;
+    std::atomic<uint64_t> _messages_late;
+};
+
+#endif // MONITOR_LOAD_GENERATOR_H
@@ -0,0 +1,380 @@
+#include "monitor_receiver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <QDebug>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+
+MonitorReceiver::MonitorReceiver(zmq::context_t &context):
+    _context(context),
+    _stop(false)
+{
+}
+
+MonitorReceiver::~MonitorReceiver()
+{
+    if( _thread.joinable() )
+    {
+        _stop = true;
+        _channels_changed.notify_all();
+        _thread.join();
+    }
+}
+
+void MonitorReceiver::addChannel(int id, const std::string &address,
+                                 const UidTable &uid_to_index,
+                                 const std::vector<NodeStatus> &initial_status,
+                                 FblWriter *recorder,
+                                 size_t history_size)
+{
+    removeChannel( id );
+
+    std::unique_ptr<Channel> channel( new Channel );
+    channel->id = id;
+    channel->address = address;
+    channel->recorder = recorder;
+    // allocated once: the receiving thread only copies into it
+    channel->history.reset( new TransitionRing( history_size ) );
+    channel->decoder.reset( new TransitionDecoder( uid_to_index, int(initial_status.size()) ) );
+    channel->index_to_uid.resize( initial_status.size() );
+    for (int uid = 0; uid < (1 << 16); uid++)
+    {
+        const int index = uid_to_index.indexOf( uint16_t(uid) );
+        if( index >= 0 && index < int(initial_status.size()) )
+        {
+            channel->index_to_uid[index] = uint16_t(uid);
+        }
+    }
+    for (NodeStatus status: initial_status)
+    {
+        channel->working.nodes.push_back( {status, NodeStatus::IDLE} );
+    }
+    channel->published = channel->working;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _channels.push_back( std::move(channel) );
+    }
+    _channels_changed.notify_all();
+
+    if( !_thread.joinable() )
+    {
+        _thread = std::thread( &MonitorReceiver::run, this );
+    }
+}
+
+void MonitorReceiver::removeChannel(int id)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (auto& channel: _channels)
+    {
+        if( channel->id == id )
+        {
+            channel->removed = true;
+        }
+    }
+    // the socket must be closed by the thread that uses it
+    _channels_changed.notify_all();
+    _channels_changed.wait( lock, [this, id]() { return findChannel(id) == nullptr; } );
+}
+
+size_t MonitorReceiver::channelsCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = 0;
+    for (const auto& channel: _channels)
+    {
+        if( !channel->removed )
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+const MonitorReceiver::Channel *MonitorReceiver::findChannel(int id) const
+{
+    for (const auto& channel: _channels)
+    {
+        if( channel->id == id )
+        {
+            return channel.get();
+        }
+    }
+    return nullptr;
+}
+
+bool MonitorReceiver::takeSnapshot(int id, Snapshot *snapshot, bool force)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Channel* channel = const_cast<Channel*>( findChannel(id) );
+    if( !channel || (!force && !channel->published_changed) )
+    {
+        return false;
+    }
+    *snapshot = channel->published;
+    channel->published_changed = false;
+    return true;
+}
+
+bool MonitorReceiver::peekSnapshot(int id, Snapshot *snapshot) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const Channel* channel = findChannel(id);
+    if( !channel )
+    {
+        return false;
+    }
+    snapshot->counters = channel->published.counters;
+    snapshot->unknown_uid = channel->published.unknown_uid;
+    snapshot->error = channel->published.error;
+    return true;
+}
+
+std::vector<char> MonitorReceiver::copyHistory(int id) const
+{
+    const TransitionRing* history = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const Channel* channel = findChannel(id);
+        if( channel )
+        {
+            history = channel->history.get();
+        }
+    }
+    // channels are removed only by removeChannel(), from the same thread as this call:
+    // the ring can be read without holding the lock, and without blocking the receiver.
+    return history ? history->copy() : std::vector<char>();
+}
+
+void MonitorReceiver::run()
+{
+    // how often _stop and the list of channels are checked while the publishers are silent
+    const long POLL_TIMEOUT_MS = 50;
+    // messages decoded from one socket before the next one gets its turn
+    const int MAX_MESSAGES_PER_POLL = 1000;
+
+    std::vector<Channel*> channels;
+    std::vector<Channel*> polled;
+    std::vector<zmq::pollitem_t> items;
+    zmq::message_t msg;
+
+    auto fail = [this](Channel* channel, const char* what)
+    {
+        qDebug() << "ZMQ receive failed: " << what;
+        channel->socket.reset();
+        std::lock_guard<std::mutex> lock(_mutex);
+        channel->published = channel->working;
+        channel->published.error = what;
+        channel->published_changed = true;
+    };
+
+    while( !_stop )
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            const size_t count = _channels.size();
+            _channels.erase( std::remove_if( _channels.begin(), _channels.end(),
+                                             [](const std::unique_ptr<Channel>& channel)
+                                             { return channel->removed; }),
+                             _channels.end() );
+            if( _channels.size() != count )
+            {
+                _channels_changed.notify_all();
+            }
+            if( _channels.empty() )
+            {
+                _channels_changed.wait_for( lock, std::chrono::milliseconds(POLL_TIMEOUT_MS) );
+                continue;
+            }
+            channels.clear();
+            for (const auto& channel: _channels)
+            {
+                channels.push_back( channel.get() );
+            }
+        }
+
+        items.clear();
+        polled.clear();
+        for (Channel* channel: channels)
+        {
+            if( !channel->socket && channel->published.error.isEmpty() )
+            {
+                try{
+                    channel->socket.reset( new zmq::socket_t( _context, ZMQ_SUB ) );
+                    channel->socket->connect( channel->address.c_str() );
+                    channel->socket->setsockopt( ZMQ_SUBSCRIBE, "", 0 );
+                }
+                catch( zmq::error_t& err)
+                {
+                    fail( channel, err.what() );
+                }
+            }
+            if( channel->socket )
+            {
+                items.push_back( { static_cast<void*>(*channel->socket), 0, ZMQ_POLLIN, 0 } );
+                polled.push_back( channel );
+            }
+        }
+        if( items.empty() )
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _channels_changed.wait_for( lock, std::chrono::milliseconds(POLL_TIMEOUT_MS) );
+            continue;
+        }
+
+        try{
+            zmq::poll( items.data(), items.size(), POLL_TIMEOUT_MS );
+        }
+        catch( zmq::error_t& err)
+        {
+            qDebug() << "ZMQ poll failed: " << err.what();
+            continue;
+        }
+
+        for (size_t i = 0; i < items.size() && !_stop; i++)
+        {
+            if( !(items[i].revents & ZMQ_POLLIN) )
+            {
+                continue;
+            }
+            Channel* channel = polled[i];
+            try{
+                // drain what is already queued
+                for (int count = 0; count < MAX_MESSAGES_PER_POLL &&
+                     channel->socket->recv( &msg, ZMQ_DONTWAIT ); count++)
+                {
+                    Counters& counters = channel->working.counters;
+                    counters.messages++;
+                    if( channel->working.unknown_uid )
+                    {
+                        continue;
+                    }
+                    const auto received = std::chrono::system_clock::now();
+                    const auto start = std::chrono::steady_clock::now();
+                    if( !decodeMessage( *channel, reinterpret_cast<const char*>(msg.data()), msg.size() ) )
+                    {
+                        channel->working.unknown_uid = true;
+                    }
+                    const double decode_time =
+                        std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+                    counters.decode_time += decode_time;
+                    counters.max_decode_time = std::max( counters.max_decode_time, decode_time );
+
+                    const TransitionLog& transitions = channel->message_transitions;
+                    if( !channel->working.unknown_uid && !transitions.empty() )
+                    {
+                        // meaningful only if the clocks of the two machines are synchronized
+                        counters.last_timestamp = transitions.timestamp( transitions.size() - 1 );
+                        counters.network_lag += std::chrono::duration<double>(
+                                    received.time_since_epoch() ).count() - counters.last_timestamp;
+                        counters.lag_samples++;
+                    }
+                    channel->working_changed = true;
+                }
+            }
+            catch( zmq::error_t& err)
+            {
+                fail( channel, err.what() );
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Channel* channel: polled)
+        {
+            if( channel->working_changed && channel->published.error.isEmpty() )
+            {
+                channel->published = channel->working;
+                channel->published_changed = true;
+                channel->working_changed = false;
+            }
+        }
+    }
+}
+
+void MonitorReceiver::setStatus(Channel& channel, int index, NodeStatus status)
+{
+    auto& nodes = channel.working.nodes;
+    // a new tick of the root: the style of the whole tree is reset
+    if( index == 1 && status == NodeStatus::RUNNING )
+    {
+        for (NodeState& node: nodes)
+        {
+            node = {NodeStatus::IDLE, NodeStatus::IDLE};
+        }
+    }
+    NodeState& node = nodes[index];
+    node.prev_status = node.status;
+    node.status = status;
+}
+
+bool MonitorReceiver::decodeMessage(Channel& channel, const char *buffer, size_t size)
+{
+    // | header_size | (uid, status) * N | num_transitions | (12 bytes transition) * M |
+    TransitionLog& transitions = channel.message_transitions;
+    transitions.clear();
+    if( size < 8 )
+    {
+        return true;
+    }
+    const uint32_t header_size = flatbuffers::ReadScalar<uint32_t>( buffer );
+    if( size_t(header_size) + 8 > size )
+    {
+        return true;
+    }
+    const uint32_t num_transitions = flatbuffers::ReadScalar<uint32_t>( &buffer[4+header_size] );
+    if( size_t(header_size) + 8 + size_t(num_transitions) * 12 > size )
+    {
+        return true;
+    }
+
+    // decode and validate everything before changing anything
+    const size_t status_count = header_size / TransitionDecoder::STATUS_RECORD_SIZE;
+    if( channel.decoder->decodeStatus( &buffer[4], status_count, channel.message_status ) < status_count )
+    {
+        return false;
+    }
+    if( channel.decoder->decode( &buffer[8+header_size], num_transitions, transitions ) < num_transitions )
+    {
+        return false;
+    }
+
+    if( channel.recorder )
+    {
+        channel.recorder->append( &buffer[8+header_size], num_transitions * TransitionDecoder::RECORD_SIZE );
+    }
+    channel.history->push( &buffer[8+header_size], num_transitions );
+
+    for(size_t row=0; row < transitions.size(); row++)
+    {
+        setStatus( channel, transitions.nodeIndex(row), transitions.status(row) );
+    }
+    channel.working.counters.transitions += transitions.size();
+
+    // The status of every node after the transitions: fixes what dropped messages missed.
+    // The fixes go to the history as transitions, at the time of the last one.
+    const double fix_time = transitions.empty() ? channel.working.counters.last_timestamp
+                                                : transitions.timestamp( transitions.size() - 1 );
+    const auto fix_timestamp = std::chrono::duration_cast<BT::Duration>(
+                std::chrono::duration<double>( fix_time ) );
+    channel.resync_records.clear();
+    for(const auto& it: channel.message_status)
+    {
+        NodeState& node = channel.working.nodes[it.first];
+        if( node.status != it.second )
+        {
+            const auto record = BT::SerializeTransition( channel.index_to_uid[it.first], fix_timestamp,
+                                                         node.status, it.second );
+            channel.resync_records.insert( channel.resync_records.end(), record.begin(), record.end() );
+            node.prev_status = node.status;
+            node.status = it.second;
+        }
+    }
+    if( !channel.resync_records.empty() )
+    {
+        channel.history->push( channel.resync_records.data(),
+                               channel.resync_records.size() / TransitionDecoder::RECORD_SIZE );
+        channel.working.counters.resyncs++;
+    }
+    return true;
+}
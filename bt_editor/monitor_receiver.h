@@ -0,0 +1,125 @@
+#ifndef MONITOR_RECEIVER_H
+#define MONITOR_RECEIVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+#include <zmq.hpp>
+
+#include "bt_editor_base.h"
+#include "transition_log.h"
+#include "transition_history.h"
+#include "fbl_writer.h"
+
+// Receives the messages of one or more BT::PublisherZMQ in its own thread.
+// The SUB sockets of all the channels are polled together, so a few receivers
+// serve any number of publishers.
+// Each message updates the latest status of the nodes in a working copy; once
+// the sockets are drained, the copy is published to a second buffer that the GUI
+// takes when it is ready to draw. A slow GUI skips intermediate states instead
+// of falling behind the publisher.
+class MonitorReceiver
+{
+public:
+    typedef TransitionCheckpoints::NodeState NodeState;
+
+    // since the channel was added
+    struct Counters{
+        uint64_t messages = 0;
+        uint64_t transitions = 0;
+        // messages whose status section had to fix the state: some were dropped before them
+        uint64_t resyncs = 0;
+        double decode_time = 0;        // seconds
+        double max_decode_time = 0;
+        // timestamp of the newest transition (clock of the publisher, seconds since epoch)
+        double last_timestamp = 0;
+        // sum of (time of reception - timestamp of the newest transition) over lag_samples messages
+        double network_lag = 0;
+        uint64_t lag_samples = 0;
+    };
+
+    struct Snapshot{
+        std::vector<NodeState> nodes;
+        Counters counters;
+        bool unknown_uid = false;  // the tree of the publisher is not the one we know
+        QString error;
+    };
+
+    MonitorReceiver(zmq::context_t& context);
+
+    ~MonitorReceiver();
+
+    // initial_status is indexed like the tree built by BuildTreeFromFlatbuffers.
+    // The transitions of every valid message are appended to recorder, if any
+    // (nothing is written while it is closed); it must outlive the channel.
+    // The newest history_size transitions are kept, see copyHistory().
+    void addChannel(int id, const std::string& address,
+                    const UidTable& uid_to_index,
+                    const std::vector<NodeStatus>& initial_status,
+                    FblWriter* recorder,
+                    size_t history_size);
+
+    // returns once the socket of the channel is closed
+    void removeChannel(int id);
+
+    size_t channelsCount() const;
+
+    // Copy the latest state of a channel. Returns false if nothing changed
+    // since the last call, unless force is true.
+    bool takeSnapshot(int id, Snapshot* snapshot, bool force = false);
+
+    // the same, without the status of the nodes, and whether anything changed or not
+    bool peekSnapshot(int id, Snapshot* snapshot) const;
+
+    // The newest transitions of a channel (12 bytes records, oldest first).
+    // What the status section of a message fixed follows its transitions, as
+    // transitions too: decoded with RestartRule::ROOT_RUNNING, they give the
+    // states shown by the receiver.
+    std::vector<char> copyHistory(int id) const;
+
+private:
+    struct Channel{
+        int id;
+        std::string address;
+        FblWriter* recorder;
+        std::unique_ptr<TransitionRing> history;
+        bool removed = false;
+
+        // used only by the receiving thread
+        std::unique_ptr<zmq::socket_t> socket;
+        std::unique_ptr<TransitionDecoder> decoder;
+        std::vector<uint16_t> index_to_uid;
+        std::vector<std::pair<int, NodeStatus>> message_status;
+        std::vector<char> resync_records;
+        TransitionLog message_transitions;
+        Snapshot working;
+        bool working_changed = false;
+
+        // protected by _mutex
+        Snapshot published;
+        bool published_changed = false;
+    };
+
+    void run();
+
+    // false if the message refers to unknown nodes
+    static bool decodeMessage(Channel& channel, const char* buffer, size_t size);
+
+    static void setStatus(Channel& channel, int index, NodeStatus status);
+
+    const Channel* findChannel(int id) const;
+
+    zmq::context_t& _context;
+    std::thread _thread;
+    std::atomic<bool> _stop;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _channels_changed;
+    std::vector<std::unique_ptr<Channel>> _channels;
+};
+
+#endif // MONITOR_RECEIVER_H
@@ -6,6 +6,17 @@
 #include <QTimer>
 #include <QLabel>
 #include <QDebug>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QSettings>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+#include <set>
+#include <algorithm>
 
 #include "mainwindow.h"
 #include "utils.h"
@@ -14,251 +25,1131 @@ SidepanelMonitor::SidepanelMonitor(QWidget *parent) :
     QFrame(parent),
     ui(new Ui::SidepanelMonitor),
     _zmq_context(1),
-    _zmq_subscriber(_zmq_context, ZMQ_SUB),
-    _connected(false),
-    _msg_count(0),
+    _next_connection_id(0),
+    _visible_connection(-1),
+    _tree_cache_clock(0),
+    _window_update_frames(0),
+    _window_update_time(0),
+    _scene_update_time(0),
+    _scene_update_rate(0),
     _parent(parent)
 {
     ui->setupUi(this);
+    _update_window_clock.start();
     _timer = new QTimer(this);
 
     connect( _timer, &QTimer::timeout, this, &SidepanelMonitor::on_timer );
+
+    // decoding is cheap: a few threads are enough for a whole fleet
+    const int receivers_count = std::max( 1, std::min( 4, QThread::idealThreadCount() / 2 ) );
+    for (int i = 0; i < receivers_count; i++)
+    {
+        _receivers.emplace_back( new MonitorReceiver(_zmq_context) );
+    }
+
+    QSettings settings;
+    ui->spinBoxRewindBuffer->setValue( settings.value("SidepanelMonitor.rewindBufferMB",
+                                                      ui->spinBoxRewindBuffer->value()).toInt() );
+
+    ui->progressBarDownload->setMaximum( DOWNLOAD_TIMEOUT_MS );
+    ui->progressBarDownload->setHidden(true);
+    ui->pushButtonCancelDownload->setHidden(true);
 }
 
 SidepanelMonitor::~SidepanelMonitor()
 {
+    // the workers use _zmq_context
+    for (auto& it: _connections)
+    {
+        cancelDownload( *it.second );
+    }
     delete ui;
 }
 
 void SidepanelMonitor::clear()
 {
-    if( _connected ) this->on_Connect();
+    removeAllConnections();
+}
+
+SidepanelMonitor::Connection *SidepanelMonitor::findConnection(int id)
+{
+    auto it = _connections.find( id );
+    return (it != _connections.end()) ? it->second.get() : nullptr;
+}
+
+SidepanelMonitor::Connection *SidepanelMonitor::selectedConnection()
+{
+    auto item = ui->listConnections->currentItem();
+    if( !item )
+    {
+        return nullptr;
+    }
+    return findConnection( item->data(Qt::UserRole).toInt() );
 }
 
 void SidepanelMonitor::on_timer()
 {
-    if( !_connected ) return;
+    auto main_win = dynamic_cast<MainWindow*>( _parent );
+    const QString visible_tab = main_win->currentTabName();
 
-    zmq::message_t msg;
-    try{
-        while(  _zmq_subscriber.recv(&msg) )
+    // the tree of a hidden tab is not drawn: its messages are merged by the
+    // receiver, and the tab is brought up to date when it is shown again
+    int visible_connection = -1;
+    for (const auto& it: _connections)
+    {
+        if( it.second->tab_name == visible_tab )
         {
-            _msg_count++;
-            ui->labelCount->setText( QString("Messages received: %1").arg(_msg_count) );
-
-            const char* buffer = reinterpret_cast<const char*>(msg.data());
-
-            const uint32_t header_size = flatbuffers::ReadScalar<uint32_t>( buffer );
-            const uint32_t num_transitions = flatbuffers::ReadScalar<uint32_t>( &buffer[4+header_size] );
-            
-            std::vector<std::pair<int, NodeStatus>> node_status;
-            // check uid in the index, if failed load tree from server
-            try{
-                for(size_t offset = 4; offset < header_size +4; offset +=3 )
-                {
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset]);
-                    _uid_to_index.at(uid);
-                }
-                
-                for(size_t t=0; t < num_transitions; t++)
-                {
-                    size_t offset = 8 + header_size + 12*t;
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
-                    _uid_to_index.at(uid);
-                }
+            visible_connection = it.first;
+        }
+    }
+    const bool shown_now = ( visible_connection != _visible_connection );
+    _visible_connection = visible_connection;
 
-                for(size_t offset = 4; offset < header_size +4; offset +=3 )
-                {
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset]);
-                    const uint16_t index = _uid_to_index.at(uid);
-                    AbstractTreeNode* node = _loaded_tree.node( index );
-                    node->status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+2] ));
-                }
+    std::vector<int> failed;
+    std::vector<int> reload;
+    bool list_changed = false;
 
-                //qDebug() << "--------";
-                for(size_t t=0; t < num_transitions; t++)
-                {
-                    size_t offset = 8 + header_size + 12*t;
-
-                    // const double t_sec  = flatbuffers::ReadScalar<uint32_t>( &buffer[offset] );
-                    // const double t_usec = flatbuffers::ReadScalar<uint32_t>( &buffer[offset+4] );
-                    // double timestamp = t_sec + t_usec* 0.000001;
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
-                    const uint16_t index = _uid_to_index.at(uid);
-                    // NodeStatus prev_status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[index+10] ));
-                    NodeStatus status  = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+11] ));
+    for (auto& it: _connections)
+    {
+        Connection& connection = *it.second;
+        if( !connection.receiver )
+        {
+            continue;
+        }
+        const bool visible = ( connection.id == visible_connection );
 
-                    _loaded_tree.node(index)->status = status;
-                    node_status.push_back( {index, status} );
+        // a paused connection keeps the tree it shows
+        const bool draw = visible && !connection.paused;
 
-                }
+        MonitorReceiver::Snapshot snapshot;
+        if( draw )
+        {
+            // only the latest state matters: the messages received in between are already merged
+            if( !connection.receiver->takeSnapshot( connection.id, &snapshot, shown_now ) )
+            {
+                continue;
             }
-            catch( std::out_of_range& err) {
-                qDebug() << "Reload tree from server";
-                if( !getTreeFromServer() ) {
-                    _connected = false;
-                    ui->lineEdit->setDisabled(false);
-                    _timer->stop();
-                    connectionUpdate(false);
-                    return;
-                }
+        }
+        else if( !connection.receiver->peekSnapshot( connection.id, &snapshot ) )
+        {
+            continue;
+        }
+
+        if( snapshot.counters.messages != connection.counters.messages )
+        {
+            list_changed = true;
+        }
+        connection.counters = snapshot.counters;
+
+        // a drawn snapshot shows all the messages received since the previous one:
+        // all but one are coalesced. Those received while not drawn are not.
+        if( draw && snapshot.counters.messages > connection.drawn_messages + 1 )
+        {
+            connection.coalesced += snapshot.counters.messages - connection.drawn_messages - 1;
+        }
+        connection.drawn_messages = snapshot.counters.messages;
+
+        if( !snapshot.error.isEmpty() )
+        {
+            qDebug() << "ZMQ receive failed: " << snapshot.error;
+            failed.push_back( connection.id );
+        }
+        else if( snapshot.unknown_uid )
+        {
+            reload.push_back( connection.id );
+        }
+        else if( draw )
+        {
+            updateNodeStyle( connection, snapshot.nodes );
+            connection.frames++;
+
+            const double timestamp = snapshot.counters.last_timestamp;
+            if( timestamp > 0 && timestamp != connection.drawn_timestamp )
+            {
+                connection.drawn_timestamp = timestamp;
+                const double now = QDateTime::currentMSecsSinceEpoch() * 0.001;
+                connection.apply_lag_total += now - timestamp;
+                connection.apply_lag_samples++;
             }
+        }
+    }
 
-            // update the graphic part
-            emit changeNodeStyle( "BehaviorTree", node_status, true );
+    bool metrics_changed = false;
+    for (auto& it: _connections)
+    {
+        Connection& connection = *it.second;
+        if( connection.receiver && connection.window_clock.elapsed() >= METRICS_WINDOW_MS )
+        {
+            updateMetrics( connection );
+            metrics_changed = true;
+        }
+    }
+    if( _update_window_clock.elapsed() >= METRICS_WINDOW_MS )
+    {
+        updateSceneMetrics();
+        metrics_changed = true;
+    }
+    if( metrics_changed )
+    {
+        showMetrics();
+    }
 
-            // lock editing of nodes
-            auto main_win = dynamic_cast<MainWindow*>( _parent );
-            main_win->lockEditing(true);
+    for (int id: reload)
+    {
+        // the tree shown stays there until the new one is received
+        qDebug() << "Reload tree from server";
+        Connection* connection = findConnection( id );
+        stopReceiver( *connection );
+        startDownload( *connection );
+    }
+    for (int id: failed)
+    {
+        removeConnection( id );
+    }
+
+    updateDownloadProgress();
+
+    if( list_changed )
+    {
+        updateConnectionsList();
+    }
+    Connection* selected = selectedConnection();
+    if( selected && selected->recorder.isOpen() )
+    {
+        QString text = QString("Record (%1 kB").arg( selected->recorder.size() / 1024 );
+        if( selected->recorder.droppedRecords() > 0 )
+        {
+            text += QString(", %1 dropped").arg( selected->recorder.droppedRecords() );
         }
+        ui->checkBoxRecord->setText( text + ")" );
+    }
+
+    for (auto& it: _connections)
+    {
+        Connection& connection = *it.second;
+        if( connection.recorder.hasFailed() )
+        {
+            // stopped before the warning: the timer keeps running while it is shown
+            const QString error = connection.recorder.error();
+            stopRecording( connection );
+            QMessageBox::warning(this, tr("Recording failed"),
+                                 tr("The recording of [%1] was stopped\n%2")
+                                 .arg(connection.tab_name).arg(error));
+            break;
+        }
+    }
+}
+
+void SidepanelMonitor::updateNodeStyle(Connection &connection,
+                                       const std::vector<MonitorReceiver::NodeState> &nodes)
+{
+    std::vector<std::pair<int, NodeStatus>> node_status;
+    for(size_t index = 0; index < nodes.size() && index < connection.displayed_state.size(); index++ )
+    {
+        const auto& node_state = nodes[index];
+        if( node_state == connection.displayed_state[index] )
+        {
+            continue;
+        }
+        // onChangeNodesStatus takes the previous status from the entries
+        // that precede in the same vector
+        if( node_state.prev_status != NodeStatus::IDLE )
+        {
+            node_status.push_back( { index, node_state.prev_status } );
+        }
+        node_status.push_back( { index, node_state.status } );
+        connection.loaded_tree.node(index)->status = node_state.status;
+    }
+    connection.displayed_state = nodes;
+
+    // update the graphic part
+    if( !node_status.empty() )
+    {
+        emit changeNodeStyle( connection.tab_name, node_status, false );
+    }
+}
+
+void SidepanelMonitor::startReceiver(Connection &connection)
+{
+    std::vector<NodeStatus> initial_status;
+    for(const auto& node: connection.loaded_tree.nodes())
+    {
+        initial_status.push_back( node.status );
+    }
+
+    // the least busy receiver
+    MonitorReceiver* receiver = _receivers.front().get();
+    for (const auto& it: _receivers)
+    {
+        if( it->channelsCount() < receiver->channelsCount() )
+        {
+            receiver = it.get();
+        }
+    }
+    // the ring of the channel is allocated once, here
+    const size_t history_size = size_t( ui->spinBoxRewindBuffer->value() ) * 1024 * 1024
+                                / TransitionDecoder::RECORD_SIZE;
+    receiver->addChannel( connection.id, connection.address_pub, connection.uid_to_index,
+                          initial_status, &connection.recorder, history_size );
+    connection.receiver = receiver;
+
+    connection.counters = MonitorReceiver::Counters();
+    connection.window_counters = MonitorReceiver::Counters();
+    connection.metrics = Connection::Metrics();
+    connection.window_clock.start();
+    connection.drawn_timestamp = 0;
+    connection.apply_lag_total = 0;
+    connection.apply_lag_samples = 0;
+    connection.frames = 0;
+    connection.coalesced = 0;
+    connection.drawn_messages = 0;
+}
+
+void SidepanelMonitor::updateMetrics(Connection &connection)
+{
+    const MonitorReceiver::Counters& now = connection.counters;
+    const MonitorReceiver::Counters& start = connection.window_counters;
+    const double window = connection.window_clock.restart() * 0.001;
+
+    Connection::Metrics& metrics = connection.metrics;
+    const uint64_t messages = now.messages - start.messages;
+
+    metrics.messages_rate = messages / window;
+    metrics.transitions_rate = (now.transitions - start.transitions) / window;
+    metrics.decode_time = messages ? (now.decode_time - start.decode_time) / messages : 0;
+    metrics.max_decode_time = now.max_decode_time;
+
+    const uint64_t lag_samples = now.lag_samples - start.lag_samples;
+    if( lag_samples > 0 )
+    {
+        metrics.network_lag = (now.network_lag - start.network_lag) / lag_samples;
     }
-    catch( zmq::error_t& err)
+    if( connection.apply_lag_samples > 0 )
     {
-        qDebug() << "ZMQ receive failed: " << err.what();
+        metrics.apply_lag = connection.apply_lag_total / connection.apply_lag_samples;
     }
+    metrics.frames = connection.frames;
+    metrics.coalesced = connection.coalesced;
+    metrics.resyncs = now.resyncs;
+
+    connection.window_counters = now;
+    connection.apply_lag_total = 0;
+    connection.apply_lag_samples = 0;
+    connection.frames = 0;
+    connection.coalesced = 0;
 }
 
-bool SidepanelMonitor::getTreeFromServer()
+void SidepanelMonitor::updateSceneMetrics()
 {
-    try{
-        zmq::message_t request(0);
-        zmq::message_t reply;
+    auto main_win = dynamic_cast<MainWindow*>( _parent );
+    const auto& stats = main_win->statusUpdateStats();
+    const double window = _update_window_clock.restart() * 0.001;
 
-        zmq::socket_t  zmq_client( _zmq_context, ZMQ_REQ );
-        zmq_client.connect( _connection_address_req.c_str() );
+    const uint64_t frames = stats.frames - _window_update_frames;
+    _scene_update_rate = frames / window;
+    _scene_update_time = frames ? (stats.total_time - _window_update_time) / frames : 0;
 
-        int timeout_ms = 10000;
-        zmq_client.setsockopt(ZMQ_RCVTIMEO,&timeout_ms, sizeof(int) );
+    _window_update_frames = stats.frames;
+    _window_update_time = stats.total_time;
+}
 
-        zmq_client.send(request);
+void SidepanelMonitor::showMetrics()
+{
+    const Connection* connection = selectedConnection();
+    if( !connection || !connection->receiver )
+    {
+        ui->labelMetrics->clear();
+        return;
+    }
+    const Connection::Metrics& metrics = connection->metrics;
+    ui->labelMetrics->setText(
+        QString("Messages: %1/s\n"
+                "Transitions: %2/s\n"
+                "Decode: %3 us/msg (max %4 us)\n"
+                "Network lag: %5 ms\n"
+                "Lag when drawn: %6 ms\n"
+                "Drawn in the last second: %7, coalesced: %8\n"
+                "Resyncs (dropped): %9\n"
+                "Scene update: %10 ms, %11/s")
+            .arg( metrics.messages_rate, 0, 'f', 1 )
+            .arg( metrics.transitions_rate, 0, 'f', 1 )
+            .arg( metrics.decode_time * 1e6, 0, 'f', 1 )
+            .arg( metrics.max_decode_time * 1e6, 0, 'f', 1 )
+            .arg( metrics.network_lag * 1e3, 0, 'f', 1 )
+            .arg( metrics.apply_lag * 1e3, 0, 'f', 1 )
+            .arg( metrics.frames )
+            .arg( metrics.coalesced )
+            .arg( metrics.resyncs )
+            .arg( _scene_update_time * 1e3, 0, 'f', 2 )
+            .arg( _scene_update_rate, 0, 'f', 1 ) );
+}
+
+QJsonObject SidepanelMonitor::metricsToJson() const
+{
+    QJsonArray connections;
+    for (const auto& it: _connections)
+    {
+        const Connection& connection = *it.second;
+        const Connection::Metrics& metrics = connection.metrics;
+        const MonitorReceiver::Counters& counters = connection.counters;
+
+        QJsonObject json;
+        json["tab"] = connection.tab_name;
+        json["address"] = QString( connection.address_pub.c_str() );
+        json["connected"] = connection.receiver != nullptr;
+        json["messages"] = double(counters.messages);
+        json["transitions"] = double(counters.transitions);
+        json["messages_per_sec"] = metrics.messages_rate;
+        json["transitions_per_sec"] = metrics.transitions_rate;
+        json["decode_time_sec"] = metrics.decode_time;
+        json["max_decode_time_sec"] = metrics.max_decode_time;
+        json["network_lag_sec"] = metrics.network_lag;
+        json["apply_lag_sec"] = metrics.apply_lag;
+        json["frames"] = double(metrics.frames);
+        json["coalesced"] = double(metrics.coalesced);
+        json["resyncs"] = double(metrics.resyncs);
+        connections.append( json );
+    }
+
+    auto main_win = dynamic_cast<MainWindow*>( _parent );
+    const auto& stats = main_win->statusUpdateStats();
+
+    QJsonObject scene;
+    scene["frames"] = double(stats.frames);
+    scene["nodes"] = double(stats.nodes);
+    scene["update_time_sec"] = _scene_update_time;
+    scene["max_update_time_sec"] = stats.max_time;
+    scene["updates_per_sec"] = _scene_update_rate;
+
+    QJsonObject json;
+    json["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    json["connections"] = connections;
+    json["scene"] = scene;
+    return json;
+}
+
+void SidepanelMonitor::on_pushButtonDumpMetrics_clicked()
+{
+    QSettings settings;
+    QString directory_path  = settings.value("SidepanelMonitor.lastRecordDirectory",
+                                             QDir::homePath() ).toString();
 
-        bool received = zmq_client.recv(&reply);
-        if( ! received )
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save the monitor metrics"),
+                                                    directory_path, tr("JSON (*.json)"));
+    if( fileName.isEmpty() )
+    {
+        return;
+    }
+    QFile file(fileName);
+    if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+    {
+        QMessageBox::warning(this, tr("Metrics"),
+                             tr("Can't write [%1]\n%2").arg(fileName).arg(file.errorString()));
+        return;
+    }
+    file.write( QJsonDocument( metricsToJson() ).toJson() );
+}
+
+void SidepanelMonitor::stopReceiver(Connection &connection)
+{
+    if( connection.receiver )
+    {
+        connection.receiver->removeChannel( connection.id );
+        connection.receiver = nullptr;
+    }
+}
+
+bool SidepanelMonitor::addConnection(const QString &address,
+                                     const QString &publisher_port,
+                                     const QString &server_port)
+{
+    const std::string address_pub = "tcp://" + address.toStdString() + ":" + publisher_port.toStdString();
+    const std::string address_req = "tcp://" + address.toStdString() + ":" + server_port.toStdString();
+
+    QStringList tab_names;
+    for (const auto& it: _connections)
+    {
+        if( it.second->address_pub == address_pub )
         {
+            QMessageBox::warning(this, tr("ZeroMQ connection"),
+                                 tr("Already connected to [%1]").arg(address_pub.c_str()));
             return false;
         }
+        tab_names.push_back( it.second->tab_name );
+    }
+
+    std::unique_ptr<Connection> connection( new Connection );
+    connection->id = _next_connection_id++;
+    connection->address_pub = address_pub;
+    connection->address_req = address_req;
+    // the first robot replaces the tree of the default tab, like a single connection always did
+    connection->tab_name = "BehaviorTree";
+    if( tab_names.contains( connection->tab_name ) )
+    {
+        connection->tab_name = QString("%1:%2").arg(address).arg(publisher_port);
+    }
+    connection->download_watcher.reset( new QFutureWatcher<TreeDownload>() );
 
-        const char* buffer = reinterpret_cast<const char*>(reply.data());
-        auto fb_behavior_tree = Serialization::GetBehaviorTree( buffer );
+    const int id = connection->id;
+    connect( connection->download_watcher.get(), &QFutureWatcher<TreeDownload>::finished,
+             this, [this, id]() { onTreeDownloaded(id); } );
 
-        auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
+    Connection& added = *connection;
+    _connections.insert( { id, std::move(connection) } );
+    startDownload( added );
+    updateConnectionsList();
+    return true;
+}
 
-        _loaded_tree  = std::move( res_pair.first );
-        _uid_to_index = std::move( res_pair.second );
+void SidepanelMonitor::removeConnection(int id)
+{
+    Connection* connection = findConnection( id );
+    if( !connection )
+    {
+        return;
+    }
+    cancelDownload( *connection );
+    stopReceiver( *connection );
+    stopRecording( *connection );
 
-        // add new models to registry
-        for(const auto& tree_node: _loaded_tree.nodes())
+    // this may be called by a signal of the watcher itself
+    connection->download_watcher.release()->deleteLater();
+    _connections.erase( id );
+    if( _visible_connection == id )
+    {
+        _visible_connection = -1;
+    }
+    updateConnectionsList();
+    updateDownloadProgress();
+
+    if( _connections.empty() )
+    {
+        _timer->stop();
+        connectionUpdate(false);
+    }
+}
+
+void SidepanelMonitor::removeAllConnections()
+{
+    std::vector<int> ids;
+    for (const auto& it: _connections)
+    {
+        ids.push_back( it.first );
+    }
+    for (int id: ids)
+    {
+        removeConnection( id );
+    }
+}
+
+void SidepanelMonitor::updateConnectionsList()
+{
+    const int selected_id = selectedConnection() ? selectedConnection()->id : -1;
+    const QSignalBlocker blocker( ui->listConnections );
+
+    // one row per connection, in the order of _connections
+    while( ui->listConnections->count() > int(_connections.size()) )
+    {
+        delete ui->listConnections->takeItem( ui->listConnections->count() - 1 );
+    }
+    int row = 0;
+    for (const auto& it: _connections)
+    {
+        const Connection& connection = *it.second;
+        QString text = connection.tab_name;
+        if( connection.downloading )
         {
-            const auto& registration_ID = tree_node.model.registration_ID;
-            if( BuiltinNodeModels().count(registration_ID) == 0)
+            text += " (waiting for the tree)";
+        }
+        else{
+            text += QString(": %1 messages").arg(connection.counters.messages);
+        }
+
+        if( row == ui->listConnections->count() )
+        {
+            ui->listConnections->addItem( text );
+        }
+        auto item = ui->listConnections->item(row);
+        item->setText( text );
+        item->setToolTip( connection.address_pub.c_str() );
+        item->setData( Qt::UserRole, connection.id );
+        if( connection.id == selected_id || (selected_id < 0 && row == 0) )
+        {
+            ui->listConnections->setCurrentRow( row );
+        }
+        row++;
+    }
+    ui->pushButtonRemoveConnection->setEnabled( !_connections.empty() );
+    updateRecordCheckBox();
+    updateRewindControls();
+}
+
+void SidepanelMonitor::on_listConnections_currentRowChanged(int)
+{
+    updateRecordCheckBox();
+    updateRewindControls();
+    showMetrics();
+}
+
+void SidepanelMonitor::startDownload(Connection& connection)
+{
+    connection.download_cancel = false;
+    connection.downloading = true;
+    connection.download_clock.start();
+
+    ui->progressBarDownload->setValue(0);
+    ui->progressBarDownload->setHidden(false);
+    ui->pushButtonCancelDownload->setHidden(false);
+    _timer->start(20);
+
+    zmq::context_t* context = &_zmq_context;
+    std::atomic<bool>* cancel = &connection.download_cancel;
+    const std::string address = connection.address_req;
+
+    std::set<QByteArray> cached_hashes;
+    for(const auto& it: _tree_cache)
+    {
+        cached_hashes.insert( it.first );
+    }
+
+    connection.download_watcher->setFuture( QtConcurrent::run( [context, cancel, address, cached_hashes]()
+    {
+        TreeDownload download;
+        try{
+            zmq::socket_t zmq_client( *context, ZMQ_REQ );
+            // closing the socket must not wait for a server that never answered
+            int linger_ms = 0;
+            zmq_client.setsockopt( ZMQ_LINGER, &linger_ms, sizeof(int) );
+            zmq_client.connect( address.c_str() );
+
+            zmq::message_t request(0);
+            zmq_client.send(request);
+
+            // wait in short steps, to notice a cancellation
+            zmq::pollitem_t items[] = { { static_cast<void*>(zmq_client), 0, ZMQ_POLLIN, 0 } };
+            QElapsedTimer clock;
+            clock.start();
+            while( !(items[0].revents & ZMQ_POLLIN) )
             {
-                addNewModel( tree_node.model );
+                if( *cancel )
+                {
+                    return download;
+                }
+                if( clock.elapsed() > DOWNLOAD_TIMEOUT_MS )
+                {
+                    download.error = "The server did not answer";
+                    return download;
+                }
+                zmq::poll( items, 1, 50 );
             }
-        }
 
-        try {
-            loadBehaviorTree( _loaded_tree, "BehaviorTree" );
+            zmq::message_t reply;
+            zmq_client.recv(&reply);
+
+            flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(reply.data()), reply.size() );
+            if( !Serialization::VerifyBehaviorTreeBuffer(verifier) ||
+                !IsConsistentTree( Serialization::GetBehaviorTree( reply.data() ) ) )
+            {
+                download.error = "The tree sent by the server is not valid";
+                return download;
+            }
+            auto fb_behavior_tree = Serialization::GetBehaviorTree( reply.data() );
+
+            download.serialized = QByteArray( reinterpret_cast<const char*>(reply.data()), int(reply.size()) );
+            download.hash = TreeStructureHash( fb_behavior_tree );
+
+            if( cached_hashes.count( download.hash ) )
+            {
+                // same structure: the status of the nodes is the only thing that may have changed
+                download.cached = true;
+                download.node_status.push_back( NodeStatus::IDLE ); // Root
+                for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
+                {
+                    download.node_status.push_back( convert( fb_node->status() ) );
+                }
+                return download;
+            }
+            auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
+            download.tree = std::move( res_pair.first );
+            download.uid_to_index = std::move( res_pair.second );
         }
-        catch (std::exception& err) {
-            QMessageBox messageBox;
-            messageBox.critical(this,"Error Connecting to remote server", err.what() );
-            messageBox.show();
-            return false;
+        catch( zmq::error_t& err)
+        {
+            download.error = err.what();
         }
+        return download;
+    }) );
+}
 
-        std::vector<std::pair<int, NodeStatus>> node_status;
-        node_status.reserve(_loaded_tree.nodesCount());
 
-        //  qDebug() << "--------";
+void SidepanelMonitor::cancelDownload(Connection& connection)
+{
+    if( !connection.downloading )
+    {
+        return;
+    }
+    connection.download_cancel = true;
+    connection.download_watcher->waitForFinished();
+    connection.downloading = false;
+}
 
-        for(size_t t=0; t < _loaded_tree.nodesCount(); t++)
+void SidepanelMonitor::updateDownloadProgress()
+{
+    // the connection that has been waiting the longest
+    qint64 elapsed = -1;
+    for (const auto& it: _connections)
+    {
+        if( it.second->downloading )
         {
-            node_status.push_back( { t, _loaded_tree.nodes()[t].status } );
+            elapsed = std::max( elapsed, it.second->download_clock.elapsed() );
         }
-        emit changeNodeStyle( "BehaviorTree", node_status, true );
     }
-    catch( zmq::error_t& err)
+    ui->progressBarDownload->setHidden( elapsed < 0 );
+    ui->pushButtonCancelDownload->setHidden( elapsed < 0 );
+    if( elapsed >= 0 )
     {
-        qDebug() << "ZMQ client receive failed: " << err.what();
-        return false;
+        ui->progressBarDownload->setValue( elapsed < DOWNLOAD_TIMEOUT_MS ? int(elapsed) : DOWNLOAD_TIMEOUT_MS );
     }
-    return true;
 }
 
-void SidepanelMonitor::on_Connect()
+void SidepanelMonitor::on_pushButtonCancelDownload_clicked()
 {
-    if( !_connected)
+    // the connections waiting for a tree are dropped
+    std::vector<int> ids;
+    for (const auto& it: _connections)
     {
-        QString address = ui->lineEdit->text();
-        if( address.isEmpty() )
+        if( it.second->downloading )
         {
-            address = ui->lineEdit->placeholderText();
-            ui->lineEdit->setText(address);
+            ids.push_back( it.first );
         }
+    }
+    for (int id: ids)
+    {
+        removeConnection( id );
+    }
+    ui->labelCount->setText( "Connection cancelled" );
+}
+
+void SidepanelMonitor::onTreeDownloaded(int id)
+{
+    Connection* connection = findConnection( id );
+    // a cancelled download has already been dealt with
+    if( !connection || !connection->downloading )
+    {
+        return;
+    }
+    connection->downloading = false;
+
+    TreeDownload download = connection->download_watcher->result();
+
+    if( !download.error.isEmpty() || !loadTree( *connection, download ) )
+    {
+        qDebug() << "ZMQ client receive failed: " << download.error;
+        const bool was_connected = connection->connected;
+        const QString address = connection->address_req.c_str();
+        removeConnection( id );
+        ui->labelCount->setText( QString("Disconnected from %1").arg(address) );
 
-        QString publisher_port = ui->lineEdit_publisher->text();
-        if( publisher_port.isEmpty() )
+        if( !was_connected )
         {
-            publisher_port = ui->lineEdit_publisher->placeholderText();
-            ui->lineEdit_publisher->setText(publisher_port);
+            QMessageBox::warning(this,
+                                 tr("ZeroMQ connection"),
+                                 tr("Was not able to connect to [%1]\n%2")
+                                 .arg(address).arg(download.error),
+                                 QMessageBox::Close);
         }
+        return;
+    }
+
+    startReceiver( *connection );
+    ui->labelCount->setText( QString("Connected to %1 publisher(s)").arg(_connections.size()) );
+    if( !connection->connected )
+    {
+        connection->connected = true;
+        connectionUpdate(true);
+    }
+    updateConnectionsList();
+    updateDownloadProgress();
+}
 
-        QString server_port = ui->lineEdit_server->text();
-        if( server_port.isEmpty() )
+bool SidepanelMonitor::sceneShowsTree(const QString& tab_name, const AbsBehaviorTree& tree)
+{
+    auto main_win = dynamic_cast<MainWindow*>( _parent );
+    auto container = main_win->getTabByName( tab_name );
+    if( !container )
+    {
+        return false;
+    }
+    auto scene_tree = BuildTreeFromScene( container->scene() );
+    if( scene_tree.nodesCount() != tree.nodesCount() )
+    {
+        return false;
+    }
+    // the status is not part of the scene
+    for(size_t index = 0; index < scene_tree.nodesCount(); index++)
+    {
+        const auto& scene_node  = scene_tree.nodes()[index];
+        const auto& loaded_node = tree.nodes()[index];
+        if( scene_node.instance_name != loaded_node.instance_name ||
+            scene_node.model.registration_ID != loaded_node.model.registration_ID )
         {
-          publisher_port = ui->lineEdit_server->placeholderText();
-          ui->lineEdit_server->setText(publisher_port);
+            return false;
         }
+    }
+    return true;
+}
 
-        bool failed = false;
-        if( !address.isEmpty() )
+void SidepanelMonitor::addCachedTree(const QByteArray &hash, const AbsBehaviorTree &tree,
+                                     const UidTable &uid_to_index)
+{
+    if( _tree_cache.size() >= MAX_CACHED_TREES && _tree_cache.count( hash ) == 0 )
+    {
+        auto oldest = std::min_element( _tree_cache.begin(), _tree_cache.end(),
+                                        [](const std::pair<const QByteArray, CachedTree>& a,
+                                           const std::pair<const QByteArray, CachedTree>& b)
+                                        { return a.second.last_used < b.second.last_used; } );
+        _tree_cache.erase( oldest );
+    }
+    CachedTree& cached = _tree_cache[ hash ];
+    cached.tree = tree;
+    cached.uid_to_index = uid_to_index;
+    cached.last_used = ++_tree_cache_clock;
+}
+
+bool SidepanelMonitor::loadTree(Connection& connection, TreeDownload& download)
+{
+    auto cached = _tree_cache.find( download.hash );
+    if( download.cached && cached == _tree_cache.end() )
+    {
+        // evicted by the download of another connection in the meantime
+        auto res_pair = BuildTreeFromFlatbuffers( Serialization::GetBehaviorTree( download.serialized.data() ) );
+        download.tree = std::move( res_pair.first );
+        download.uid_to_index = std::move( res_pair.second );
+        download.cached = false;
+    }
+
+    bool same_scene = false;
+
+    if( download.cached )
+    {
+        cached->second.last_used = ++_tree_cache_clock;
+        const AbsBehaviorTree& tree = cached->second.tree;
+
+        // a new connection to the same process finds the tree that a previous one loaded
+        auto tab_hash = _tab_tree_hash.find( connection.tab_name );
+        same_scene = ( tab_hash != _tab_tree_hash.end() && tab_hash->second == download.hash &&
+                       sceneShowsTree( connection.tab_name, tree ) );
+
+        connection.loaded_tree  = tree;
+        connection.uid_to_index = cached->second.uid_to_index;
+
+        for(size_t index = 0; index < download.node_status.size() && index < connection.loaded_tree.nodesCount(); index++)
         {
-            _connection_address_pub = "tcp://" + address.toStdString() + ":" + publisher_port.toStdString();
-            _connection_address_req = "tcp://" + address.toStdString() + ":" + server_port.toStdString();
+            connection.loaded_tree.node(index)->status = download.node_status[index];
+        }
+    }
+    else{
+        addCachedTree( download.hash, download.tree, download.uid_to_index );
 
-            try{
-                _zmq_subscriber.connect( _connection_address_pub.c_str() );
+        connection.loaded_tree  = std::move( download.tree );
+        connection.uid_to_index = std::move( download.uid_to_index );
+    }
 
-                int timeout_ms = 1;
-                _zmq_subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
-                _zmq_subscriber.setsockopt(ZMQ_RCVTIMEO,&timeout_ms, sizeof(int) );
+    if( download.hash != connection.loaded_tree_hash && connection.recorder.isOpen() )
+    {
+        // the uids of the transitions would not match the header of the file
+        stopRecording( connection );
+        QMessageBox::warning(this, tr("Recording stopped"),
+                             tr("The tree of [%1] changed: the recording has been stopped.")
+                             .arg(connection.tab_name));
+    }
+    connection.loaded_tree_hash = download.hash;
+    connection.loaded_tree_buffer = download.serialized;
 
-                if( !getTreeFromServer() )
-                {
-                    failed = true;
-                    _connected = false;
-                }
-            }
-            catch(zmq::error_t& err)
+    // the transitions to rewind belong to the previous tree
+    connection.paused = false;
+    connection.rewind_log.clear();
+    connection.rewind_checkpoints.clear();
+
+    const AbsBehaviorTree& loaded_tree = connection.loaded_tree;
+
+    if( !same_scene )
+    {
+        // add new models to registry
+        for(const auto& tree_node: loaded_tree.nodes())
+        {
+            const auto& registration_ID = tree_node.model.registration_ID;
+            if( BuiltinNodeModels().count(registration_ID) == 0)
             {
-                failed = true;
+                addNewModel( tree_node.model );
             }
         }
-        else {
-            failed = true;
+
+        try {
+            // the scene is replaced in one step
+            loadBehaviorTree( loaded_tree, connection.tab_name );
+        }
+        catch (std::exception& err) {
+            download.error = err.what();
+            connection.loaded_tree_hash.clear();
+            _tab_tree_hash.erase( connection.tab_name );
+            return false;
         }
+        _tab_tree_hash[ connection.tab_name ] = download.hash;
+    }
 
-        if( !failed )
+    std::vector<std::pair<int, NodeStatus>> node_status;
+    node_status.reserve(loaded_tree.nodesCount());
+    connection.displayed_state.clear();
+
+    for(size_t t=0; t < loaded_tree.nodesCount(); t++)
+    {
+        node_status.push_back( { t, loaded_tree.nodes()[t].status } );
+        connection.displayed_state.push_back( { loaded_tree.nodes()[t].status, NodeStatus::IDLE } );
+    }
+    emit changeNodeStyle( connection.tab_name, node_status, true );
+
+    // lock editing of nodes
+    auto main_win = dynamic_cast<MainWindow*>( _parent );
+    main_win->lockEditing(true);
+    return true;
+}
+
+void SidepanelMonitor::on_Connect()
+{
+    if( _connections.empty() )
+    {
+        on_pushButtonAddConnection_clicked();
+    }
+    else{
+        removeAllConnections();
+    }
+}
+
+void SidepanelMonitor::on_pushButtonAddConnection_clicked()
+{
+    QString address = ui->lineEdit->text();
+    if( address.isEmpty() )
+    {
+        address = ui->lineEdit->placeholderText();
+        ui->lineEdit->setText(address);
+    }
+
+    QString publisher_port = ui->lineEdit_publisher->text();
+    if( publisher_port.isEmpty() )
+    {
+        publisher_port = ui->lineEdit_publisher->placeholderText();
+        ui->lineEdit_publisher->setText(publisher_port);
+    }
+
+    QString server_port = ui->lineEdit_server->text();
+    if( server_port.isEmpty() )
+    {
+      server_port = ui->lineEdit_server->placeholderText();
+      ui->lineEdit_server->setText(server_port);
+    }
+
+    if( address.isEmpty() )
+    {
+        QMessageBox::warning(this,
+                             tr("ZeroMQ connection"),
+                             tr("Was not able to connect to [%1]\n").arg(address),
+                             QMessageBox::Close);
+        return;
+    }
+    // connected (or not) in onTreeDownloaded()
+    addConnection( address, publisher_port, server_port );
+}
+
+void SidepanelMonitor::on_pushButtonRemoveConnection_clicked()
+{
+    Connection* connection = selectedConnection();
+    if( connection )
+    {
+        removeConnection( connection->id );
+    }
+}
+
+void SidepanelMonitor::on_checkBoxRecord_toggled(bool checked)
+{
+    Connection* connection = selectedConnection();
+    if( !connection )
+    {
+        return;
+    }
+    if( !checked )
+    {
+        stopRecording( *connection );
+        return;
+    }
+
+    QSettings settings;
+    QString directory_path  = settings.value("SidepanelMonitor.lastRecordDirectory",
+                                             QDir::homePath() ).toString();
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Record the monitored tree"),
+                                                    directory_path, tr("Flatbuffers log (*.fbl)"));
+    // the connection may have been removed while the dialog was open
+    connection = selectedConnection();
+    if( fileName.isEmpty() || !connection )
+    {
+        updateRecordCheckBox();
+        return;
+    }
+    if( !fileName.endsWith(".fbl") )
+    {
+        fileName += ".fbl";
+    }
+
+    QString error;
+    if( !connection->recorder.open( fileName, connection->loaded_tree_buffer, &error ) )
+    {
+        updateRecordCheckBox();
+        QMessageBox::warning(this, tr("Recording failed"),
+                             tr("Can't write [%1]\n%2").arg(fileName).arg(error));
+        return;
+    }
+    directory_path = QFileInfo(fileName).absolutePath();
+    settings.setValue("SidepanelMonitor.lastRecordDirectory", directory_path);
+}
+
+void SidepanelMonitor::stopRecording(Connection& connection)
+{
+    connection.recorder.close();
+    updateRecordCheckBox();
+}
+
+void SidepanelMonitor::updateRecordCheckBox()
+{
+    // the checkbox refers to the selected connection
+    Connection* connection = selectedConnection();
+    const QSignalBlocker blocker( ui->checkBoxRecord );
+    ui->checkBoxRecord->setEnabled( connection && connection->connected );
+    ui->checkBoxRecord->setChecked( connection && connection->recorder.isOpen() );
+    if( !ui->checkBoxRecord->isChecked() )
+    {
+        ui->checkBoxRecord->setText( "Record" );
+    }
+}
+
+void SidepanelMonitor::on_pushButtonPause_toggled(bool checked)
+{
+    Connection* connection = selectedConnection();
+    if( connection && connection->receiver && checked != connection->paused )
+    {
+        if( checked )
         {
-            _connected = true;
-            ui->lineEdit->setDisabled(true);
-            ui->lineEdit_publisher->setDisabled(true);
-            _timer->start(20);
-            connectionUpdate(true);
+            startRewind( *connection );
         }
         else{
-            QMessageBox::warning(this,
-                                 tr("ZeroMQ connection"),
-                                 tr("Was not able to connect to [%1]\n").arg(_connection_address_pub.c_str()),
-                                 QMessageBox::Close);
+            stopRewind( *connection );
         }
     }
-    else{
-        _connected = false;
-        ui->lineEdit->setDisabled(false);
-        ui->lineEdit_publisher->setDisabled(false);
-        _timer->stop();
+    updateRewindControls();
+}
 
-        connectionUpdate(false);
+void SidepanelMonitor::startRewind(Connection &connection)
+{
+    // the receiver keeps writing into the ring: we work on a copy
+    const std::vector<char> records = connection.receiver->copyHistory( connection.id );
+    const size_t count = records.size() / TransitionDecoder::RECORD_SIZE;
+    const int nodes_count = int( connection.loaded_tree.nodesCount() );
+
+    // the restarts and the fixes of the status sections are applied like MonitorReceiver does
+    TransitionLog& log = connection.rewind_log;
+    log.clear();
+    TransitionDecoder decoder( connection.uid_to_index, nodes_count );
+    decoder.setRestartRule( TransitionDecoder::RestartRule::ROOT_RUNNING );
+    decoder.decode( records.data(), count, log );
+
+    // The ring starts in the middle of the stream. A node is in the status that its first
+    // transition comes from; the nodes without transitions did not change since then.
+    TransitionCheckpoints::TreeState initial_state = connection.displayed_state;
+    initial_state.resize( nodes_count, {NodeStatus::IDLE, NodeStatus::IDLE} );
+    std::vector<bool> found( nodes_count, false );
+    for (size_t row = 0; row < log.size(); row++)
+    {
+        const int index = log.nodeIndex(row);
+        if( !found[index] )
+        {
+            found[index] = true;
+            initial_state[index] = { log.prevStatus(row), NodeStatus::IDLE };
+        }
+    }
+
+    connection.rewind_checkpoints.reset( nodes_count, initial_state );
+    connection.rewind_checkpoints.append( log, 0 );
+    connection.paused = true;
+}
+
+void SidepanelMonitor::stopRewind(Connection &connection)
+{
+    connection.paused = false;
+    connection.rewind_log.clear();
+    connection.rewind_checkpoints.clear();
+
+    // the messages received during the pause are already merged in the latest snapshot
+    MonitorReceiver::Snapshot snapshot;
+    if( connection.receiver &&
+        connection.receiver->takeSnapshot( connection.id, &snapshot, true ) &&
+        snapshot.error.isEmpty() && !snapshot.unknown_uid )
+    {
+        updateNodeStyle( connection, snapshot.nodes );
+    }
+}
+
+void SidepanelMonitor::on_sliderRewind_valueChanged(int value)
+{
+    Connection* connection = selectedConnection();
+    if( !connection || !connection->paused || connection->rewind_log.empty() )
+    {
+        return;
+    }
+    const TransitionLog& log = connection->rewind_log;
+    const size_t row = std::min( size_t(std::max(value, 0)), log.size() - 1 );
+
+    updateNodeStyle( *connection, connection->rewind_checkpoints.stateAtRow( log, row ) );
+
+    const double relative_time = log.timestamp(row) - log.timestamp( log.size() - 1 );
+    ui->labelRewind->setText( QString("%1 s (%2 of %3 transitions)")
+                              .arg( relative_time, 0, 'f', 3 )
+                              .arg( row + 1 ).arg( log.size() ) );
+}
+
+void SidepanelMonitor::on_spinBoxRewindBuffer_valueChanged(int value)
+{
+    QSettings settings;
+    settings.setValue("SidepanelMonitor.rewindBufferMB", value);
+}
+
+void SidepanelMonitor::updateRewindControls()
+{
+    Connection* connection = selectedConnection();
+    const bool paused = connection && connection->paused;
+    {
+        const QSignalBlocker blocker( ui->pushButtonPause );
+        ui->pushButtonPause->setEnabled( connection && connection->receiver );
+        ui->pushButtonPause->setChecked( paused );
+    }
+
+    const bool can_rewind = paused && !connection->rewind_log.empty();
+    ui->sliderRewind->setEnabled( can_rewind );
+    if( !can_rewind )
+    {
+        const QSignalBlocker blocker( ui->sliderRewind );
+        ui->sliderRewind->setRange( 0, 0 );
+        ui->labelRewind->setText( paused ? "No transition received yet" : "Live" );
+        return;
+    }
+    const int last_row = int( connection->rewind_log.size() ) - 1;
+    if( ui->sliderRewind->maximum() != last_row )
+    {
+        // a new pause starts from the latest transition
+        const QSignalBlocker blocker( ui->sliderRewind );
+        ui->sliderRewind->setRange( 0, last_row );
+        ui->sliderRewind->setPageStep( std::max( 1, last_row / 100 ) );
+        ui->sliderRewind->setValue( last_row );
     }
+    // only the differences with the tree shown are emitted
+    on_sliderRewind_valueChanged( ui->sliderRewind->value() );
 }
@@ -1,10 +1,19 @@
 #ifndef SIDEPANEL_MONITOR_H
 #define SIDEPANEL_MONITOR_H
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <QFrame>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QJsonObject>
 #include <zmq.hpp>
 
 #include "bt_editor_base.h"
+#include "monitor_receiver.h"
+#include "fbl_writer.h"
+#include "transition_history.h"
 
 namespace Ui {
 class SidepanelMonitor;
@@ -20,6 +29,12 @@ public:
 
     void clear();
 
+    // the metrics of every connection and of the scene updates
+    QJsonObject metricsToJson() const;
+
+    // a connection whose server does not send the tree within this time is dropped
+    static const int DOWNLOAD_TIMEOUT_MS = 10000;
+
 public slots:
 
     void on_Connect();
@@ -28,6 +43,24 @@ private slots:
 
     void on_timer();
 
+    void on_pushButtonCancelDownload_clicked();
+
+    void on_pushButtonAddConnection_clicked();
+
+    void on_pushButtonRemoveConnection_clicked();
+
+    void on_listConnections_currentRowChanged(int row);
+
+    void on_checkBoxRecord_toggled(bool checked);
+
+    void on_pushButtonDumpMetrics_clicked();
+
+    void on_pushButtonPause_toggled(bool checked);
+
+    void on_sliderRewind_valueChanged(int value);
+
+    void on_spinBoxRewindBuffer_valueChanged(int value);
+
 signals:
     void loadBehaviorTree(const AbsBehaviorTree& tree, const QString &bt_name );
 
@@ -43,17 +76,166 @@ private:
     Ui::SidepanelMonitor *ui;
 
     zmq::context_t _zmq_context;
-    zmq::socket_t  _zmq_subscriber;
 
-    bool _connected;
-    std::string _connection_address_pub;
-    std::string _connection_address_req;
+    // The tree is requested to the server by a worker thread, so that a slow
+    // or restarting robot does not freeze the editor. The scene is replaced
+    // only once the whole tree has been received and parsed.
+    struct TreeDownload{
+        QByteArray serialized;
+        QByteArray hash;                  // TreeStructureHash: the status is not part of it
+        bool cached = false;              // if true, tree and uid_to_index are not built
+        std::vector<NodeStatus> node_status;
+        AbsBehaviorTree tree;
+        UidTable uid_to_index;
+        QString error;
+    };
+
+    // One monitored publisher, shown in its own tab
+    struct Connection{
+        int id;
+        QString tab_name;
+        std::string address_pub;
+        std::string address_req;
+
+        bool connected = false;           // true once the first tree has been loaded
+        MonitorReceiver* receiver = nullptr;
+
+        AbsBehaviorTree loaded_tree;
+        UidTable uid_to_index;
+        QByteArray loaded_tree_hash;
+        // the flatbuffer of loaded_tree: the header of the recorded logs
+        QByteArray loaded_tree_buffer;
+
+        // what has been sent with changeNodeStyle, to emit only the differences
+        std::vector<MonitorReceiver::NodeState> displayed_state;
+
+        std::unique_ptr<QFutureWatcher<TreeDownload>> download_watcher;
+        std::atomic<bool> download_cancel{false};
+        QElapsedTimer download_clock;
+        bool downloading = false;
+
+        // writes the transitions received to a .fbl file; used by receiver
+        FblWriter recorder;
+
+        // While paused, the tree is not updated by the receiver: it shows a
+        // row of the transitions copied from its ring when the pause started.
+        bool paused = false;
+        TransitionLog rewind_log;
+        TransitionCheckpoints rewind_checkpoints;
+
+        // Live metrics, computed over windows of METRICS_WINDOW_MS from the
+        // counters of the receiver. Lags compare the clock of the publisher
+        // with ours: they are meaningful only if the two are synchronized.
+        struct Metrics{
+            double messages_rate = 0;      // per second
+            double transitions_rate = 0;
+            double decode_time = 0;        // mean per message, seconds
+            double max_decode_time = 0;
+            double network_lag = 0;        // publisher -> receiver thread, seconds
+            double apply_lag = 0;          // publisher -> drawn, seconds
+            uint64_t frames = 0;           // snapshots drawn in the window
+            uint64_t coalesced = 0;        // messages of the window merged with others in one snapshot
+            uint64_t resyncs = 0;          // messages that revealed dropped ones
+        };
+        Metrics metrics;
+        MonitorReceiver::Counters counters;
+        MonitorReceiver::Counters window_counters;   // at the start of the window
+        QElapsedTimer window_clock;
+        double drawn_timestamp = 0;   // the newest transition drawn
+        double apply_lag_total = 0;
+        uint64_t apply_lag_samples = 0;
+        uint64_t frames = 0;
+        uint64_t coalesced = 0;
+        uint64_t drawn_messages = 0;  // the messages counter of the last snapshot taken
+    };
+    std::map<int, std::unique_ptr<Connection>> _connections;
+    int _next_connection_id;
+
+    // The messages of all the connections are decoded by a few receiver threads
+    std::vector<std::unique_ptr<MonitorReceiver>> _receivers;
+
+    // only the connection shown in the current tab is drawn
+    int _visible_connection;
+
     QTimer* _timer;
-    int _msg_count;
-    AbsBehaviorTree _loaded_tree;
-    std::unordered_map<int, int> _uid_to_index;
 
-    bool getTreeFromServer();
+    Connection* findConnection(int id);
+
+    // the connection selected in listConnections
+    Connection* selectedConnection();
+
+    bool addConnection(const QString& address, const QString& publisher_port, const QString& server_port);
+
+    void removeConnection(int id);
+
+    void removeAllConnections();
+
+    void updateConnectionsList();
+
+    void startReceiver(Connection& connection);
+
+    void stopReceiver(Connection& connection);
+
+    void startDownload(Connection& connection);
+
+    // stop the worker and wait for it; the result is discarded
+    void cancelDownload(Connection& connection);
+
+    void onTreeDownloaded(int id);
+
+    void updateDownloadProgress();
+
+    bool loadTree(Connection& connection, TreeDownload& download);
+
+    // emit the nodes whose status differs from what is displayed
+    void updateNodeStyle(Connection& connection, const std::vector<MonitorReceiver::NodeState>& nodes);
+
+    // The trees received so far, by hash. When a monitored process restarts
+    // with the same tree, neither the flatbuffer nor the scene are rebuilt.
+    // The least recently used tree is dropped first.
+    struct CachedTree{
+        AbsBehaviorTree tree;
+        UidTable uid_to_index;
+        uint64_t last_used = 0;
+    };
+    static const size_t MAX_CACHED_TREES = 8;
+    std::map<QByteArray, CachedTree> _tree_cache;
+    uint64_t _tree_cache_clock;
+
+    void addCachedTree(const QByteArray& hash, const AbsBehaviorTree& tree, const UidTable& uid_to_index);
+
+    // the hash of the tree loaded in each tab, whatever the connection that loaded it
+    std::map<QString, QByteArray> _tab_tree_hash;
+
+    // false if the scene of the tab has been changed since tree was loaded
+    bool sceneShowsTree(const QString& tab_name, const AbsBehaviorTree& tree);
+
+    void stopRecording(Connection& connection);
+
+    void updateRecordCheckBox();
+
+    void startRewind(Connection& connection);
+
+    // back to the live state
+    void stopRewind(Connection& connection);
+
+    // the rewind controls refer to the selected connection
+    void updateRewindControls();
+
+    static const int METRICS_WINDOW_MS = 1000;
+
+    // status updates applied by MainWindow, at the start of the metrics window
+    uint64_t _window_update_frames;
+    double _window_update_time;
+    QElapsedTimer _update_window_clock;
+    double _scene_update_time;     // mean per frame, seconds
+    double _scene_update_rate;     // frames per second
+
+    void updateMetrics(Connection& connection);
+
+    void updateSceneMetrics();
+
+    void showMetrics();
 
     QWidget *_parent;
 
@@ -5,146 +5,584 @@
 #include <QFile>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QFileDialog>
 #include <QSettings>
 #include <QKeyEvent>
-#include <QStandardItem>
 #include <QModelIndex>
+#include <QBrush>
 #include <QTimer>
 #include <QMessageBox>
+#include <QSortFilterProxyModel>
 
 #include "bt_editor_base.h"
 #include "mainwindow.h"
 #include "utils.h"
 
+// Read-only view over SidepanelReplay::_transitions.
+// Nothing is stored per row: text, colors and fonts are computed in data()
+// only for the cells that the view actually asks for.
+// When a filter is set, the view shows only the rows returned by the
+// TransitionIndex; rows of the view are mapped to rows of the log.
+class SidepanelReplay::TableModel : public QAbstractTableModel
+{
+public:
+    TableModel(SidepanelReplay* replay):
+        QAbstractTableModel(replay),
+        _replay(replay),
+        _current_row(-1),
+        _filtered(false)
+    {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        if( parent.isValid() )
+        {
+            return 0;
+        }
+        return static_cast<int>( _filtered ? _visible_rows.size() : _replay->_transitions.size() );
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : 4;
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+    {
+        if( orientation != Qt::Horizontal || role != Qt::DisplayRole )
+        {
+            return QAbstractTableModel::headerData(section, orientation, role);
+        }
+        switch(section)
+        {
+        case 0: return "Time";
+        case 1: return "Node Name";
+        case 2: return "Previous";
+        case 3: return "Status";
+        }
+        return QVariant();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    // the filter, if any, is kept
+    void reset()
+    {
+        beginResetModel();
+        _current_row = -1;
+        _visible_rows.clear();
+        endResetModel();
+    }
+
+    // when filtered, the rows added to the log are not visible until
+    // appendVisibleRows() is called
+    void beginAppendRows(int count)
+    {
+        if( !_filtered )
+        {
+            beginInsertRows( QModelIndex(), rowCount(), rowCount() + count - 1 );
+        }
+    }
+
+    void endAppendRows()
+    {
+        if( !_filtered )
+        {
+            endInsertRows();
+        }
+    }
+
+    bool isFiltered() const { return _filtered; }
+
+    // show only these rows of the log (sorted)
+    void setFilter(std::vector<uint32_t> rows)
+    {
+        beginResetModel();
+        _visible_rows = std::move(rows);
+        _filtered = true;
+        endResetModel();
+    }
+
+    void clearFilter()
+    {
+        beginResetModel();
+        _visible_rows.clear();
+        _filtered = false;
+        endResetModel();
+    }
+
+    // rows of the log that match the filter, after the ones already visible
+    void appendVisibleRows(const std::vector<uint32_t>& rows)
+    {
+        if( !_filtered || rows.empty() )
+        {
+            return;
+        }
+        beginInsertRows( QModelIndex(), rowCount(), rowCount() + int(rows.size()) - 1 );
+        _visible_rows.insert( _visible_rows.end(), rows.begin(), rows.end() );
+        endInsertRows();
+    }
+
+    // row of the log shown at view_row
+    int sourceRow(int view_row) const
+    {
+        return _filtered ? static_cast<int>(_visible_rows[view_row]) : view_row;
+    }
+
+    // last view row showing a row of the log not greater than source_row, -1 if none
+    int viewRow(int source_row) const
+    {
+        if( !_filtered || source_row < 0 )
+        {
+            return source_row;
+        }
+        auto it = std::upper_bound( _visible_rows.begin(), _visible_rows.end(),
+                                    static_cast<uint32_t>(source_row) );
+        return static_cast<int>(it - _visible_rows.begin()) - 1;
+    }
+
+    // rows up to current_row are highlighted in the first two columns
+    void setCurrentRow(int row);
+
+    void setBoldFont(const QFont& font) { _bold_font = font; }
+
+private:
+
+    bool isTimepoint(int row) const
+    {
+        const auto& timepoint = _replay->_timepoint;
+        auto it = std::lower_bound( timepoint.begin(), timepoint.end(), row,
+                                    [](const std::pair<double,int>& a, int val)
+        {
+            return a.second < val;
+        });
+        return it != timepoint.end() && it->second == row;
+    }
+
+    SidepanelReplay* _replay;
+    int _current_row;
+    QFont _bold_font;
+    bool _filtered;
+    std::vector<uint32_t> _visible_rows;
+};
+
+static QString statusText(NodeStatus status)
+{
+    switch (status)
+    {
+    case NodeStatus::SUCCESS: return "SUCCESS";
+    case NodeStatus::FAILURE: return "FAILURE";
+    case NodeStatus::RUNNING: return "RUNNING";
+    case NodeStatus::IDLE:    return "IDLE";
+    }
+    return QString();
+}
+
+static QColor statusColor(NodeStatus status)
+{
+    switch (status)
+    {
+    case NodeStatus::SUCCESS: return QColor::fromRgb(22, 255, 22);
+    case NodeStatus::FAILURE: return QColor::fromRgb(255, 22, 22);
+    case NodeStatus::RUNNING: return QColor::fromRgb(160, 160, 250);
+    case NodeStatus::IDLE:    return QColor::fromRgb(222, 222, 222);
+    }
+    return QColor();
+}
+
+QVariant SidepanelReplay::TableModel::data(const QModelIndex &index, int role) const
+{
+    if( !index.isValid() || index.row() >= rowCount() )
+    {
+        return QVariant();
+    }
+
+    const int row = sourceRow( index.row() );
+    const TransitionLog& transitions = _replay->_transitions;
+
+    switch( index.column() )
+    {
+    case 0:{
+        if( role == Qt::DisplayRole )
+        {
+            const double first_timestamp = transitions.timestamp(0);
+            return QString::number( transitions.timestamp(row) - first_timestamp, 'f', 3 );
+        }
+        if( role == Qt::ToolTipRole )
+        {
+            return QString("absolute time: %1").arg( transitions.timestamp(row), 0, 'f', 3 );
+        }
+        if( role == Qt::FontRole && isTimepoint(row) )
+        {
+            return _bold_font;
+        }
+    } break;
+
+    case 1:{
+        if( role == Qt::DisplayRole )
+        {
+            return _replay->_loaded_tree.node( transitions.nodeIndex(row) )->instance_name;
+        }
+    } break;
+
+    case 2:
+    case 3:{
+        const NodeStatus status = (index.column() == 2) ? transitions.prevStatus(row) :
+                                                          transitions.status(row);
+        if( role == Qt::DisplayRole )
+        {
+            return statusText( status );
+        }
+        if( role == Qt::BackgroundRole )
+        {
+            return QBrush( statusColor(status) );
+        }
+        if( role == Qt::ForegroundRole )
+        {
+            return QBrush( QColor::fromRgb(0, 0, 0) );
+        }
+    } break;
+    }
+
+    if( role == Qt::BackgroundRole && index.column() < 2 )
+    {
+        return (row <= _current_row) ? QBrush( QColor::fromRgb(210, 210, 210) ) :
+                                       QBrush( QColor::fromRgb(255, 255, 255) );
+    }
+    return QVariant();
+}
+
+void SidepanelReplay::TableModel::setCurrentRow(int row)
+{
+    if( row == _current_row )
+    {
+        return;
+    }
+    const int first = std::max( 0, std::min(row, _current_row) + 1 );
+    const int last  = std::max( row, _current_row );
+    _current_row = row;
+
+    // rows of the log in [first, last] changed; only some of them may be visible
+    const int view_first = viewRow( first - 1 ) + 1;
+    const int view_last  = viewRow( last );
+
+    if( view_first <= view_last )
+    {
+        emit dataChanged( index(view_first, 0), index(view_last, 1), {Qt::BackgroundRole} );
+    }
+}
+
+// One row per node of the loaded tree. The summaries are copied on refresh(),
+// because the percentiles are too expensive to compute in data().
+class SidepanelReplay::StatsModel : public QAbstractTableModel
+{
+public:
+    enum Column{ NAME, TICKS, SUCCESS, FAILURE, MEAN, P95, MAX, TOTAL, COLUMNS_COUNT };
+
+    StatsModel(SidepanelReplay* replay):
+        QAbstractTableModel(replay),
+        _replay(replay)
+    {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : static_cast<int>(_summaries.size());
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : COLUMNS_COUNT;
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+    {
+        if( orientation != Qt::Horizontal )
+        {
+            return QAbstractTableModel::headerData(section, orientation, role);
+        }
+        if( role == Qt::DisplayRole )
+        {
+            switch(section)
+            {
+            case NAME:    return "Node Name";
+            case TICKS:   return "Ticks";
+            case SUCCESS: return "Success";
+            case FAILURE: return "Failures";
+            case MEAN:    return "Mean";
+            case P95:     return "P95";
+            case MAX:     return "Max";
+            case TOTAL:   return "Total";
+            }
+        }
+        if( role == Qt::ToolTipRole )
+        {
+            switch(section)
+            {
+            case TICKS:   return "Number of times the node left IDLE";
+            case SUCCESS: return "SUCCESS / (SUCCESS + FAILURE)";
+            case FAILURE: return "Number of transitions to FAILURE";
+            case MEAN:
+            case P95:
+            case MAX:     return "Duration of the RUNNING periods, in seconds";
+            case TOTAL:   return "Total time spent RUNNING, in seconds";
+            }
+        }
+        return QVariant();
+    }
+
+    // Qt::UserRole is the numeric value, used to sort
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if( !index.isValid() || index.row() >= rowCount() )
+        {
+            return QVariant();
+        }
+        const TransitionStats::Summary& summary = _summaries[index.row()];
+
+        if( index.column() == NAME )
+        {
+            if( role == Qt::DisplayRole || role == Qt::UserRole )
+            {
+                return _replay->_loaded_tree.node( index.row() )->instance_name;
+            }
+            return QVariant();
+        }
+
+        if( role == Qt::TextAlignmentRole )
+        {
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        if( role != Qt::DisplayRole && role != Qt::UserRole )
+        {
+            return QVariant();
+        }
+
+        const bool display = (role == Qt::DisplayRole);
+        const bool has_running = summary.running_count > 0;
+
+        switch( index.column() )
+        {
+        case TICKS:   return summary.ticks;
+        case FAILURE: return summary.failure;
+        case SUCCESS:{
+            const double ratio = summary.successRatio();
+            if( !display )
+            {
+                return ratio;
+            }
+            return (ratio < 0) ? QString("-") : QString("%1%").arg( ratio * 100.0, 0, 'f', 1 );
+        }
+        case MEAN:  return duration( summary.running_mean,  has_running, display );
+        case P95:   return duration( summary.running_p95,   has_running, display );
+        case MAX:   return duration( summary.running_max,   has_running, display );
+        case TOTAL: return duration( summary.running_total, has_running, display );
+        }
+        return QVariant();
+    }
+
+    void refresh()
+    {
+        const TransitionStats& stats = _replay->_stats;
+        const bool resized = ( stats.nodesCount() != _summaries.size() );
+        if( resized )
+        {
+            beginResetModel();
+        }
+        _summaries.resize( stats.nodesCount() );
+        for (size_t index = 0; index < _summaries.size(); index++)
+        {
+            _summaries[index] = stats.summary(index);
+        }
+        if( resized )
+        {
+            endResetModel();
+        }
+        else if( !_summaries.empty() )
+        {
+            emit dataChanged( index(0, TICKS), index(rowCount()-1, COLUMNS_COUNT-1) );
+        }
+    }
+
+private:
+
+    static QVariant duration(double value, bool valid, bool display)
+    {
+        if( !display )
+        {
+            return valid ? value : -1.0;
+        }
+        return valid ? QString::number( value, 'f', 3 ) : QString("-");
+    }
+
+    SidepanelReplay* _replay;
+    std::vector<TransitionStats::Summary> _summaries;
+};
+
 
 SidepanelReplay::SidepanelReplay(QWidget *parent) :
     QFrame(parent),
     ui(new Ui::SidepanelReplay),
+    _stats_dirty(false),
     _prev_row(-1),
+    _loading(false),
+    _read_offset(0),
     _parent(parent)
 {
     ui->setupUi(this);
 
-    _table_model = new QStandardItemModel(0,4, this);
+    _table_model = new TableModel(this);
 
-    _table_model->setHeaderData(0,Qt::Horizontal, "Time");
-    _table_model->setHeaderData(1,Qt::Horizontal, "Node Name");
-    _table_model->setHeaderData(2,Qt::Horizontal, "Previous");
-    _table_model->setHeaderData(3,Qt::Horizontal, "Status");
+    QFont bold_font = ui->tableView->font();
+    bold_font.setBold(true);
+    _table_model->setBoldFont( bold_font );
 
     ui->tableView->setModel(_table_model);
     ui->tableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
 
+    _stats_model = new StatsModel(this);
+    auto stats_proxy = new QSortFilterProxyModel(this);
+    stats_proxy->setSourceModel( _stats_model );
+    stats_proxy->setSortRole( Qt::UserRole );
+    ui->tableViewStats->setModel( stats_proxy );
+    ui->tableViewStats->sortByColumn( StatsModel::TOTAL, Qt::DescendingOrder );
+    ui->tableViewStats->horizontalHeader()->setSectionResizeMode( QHeaderView::ResizeToContents );
+    ui->tableViewStats->horizontalHeader()->setSectionResizeMode( StatsModel::NAME, QHeaderView::Stretch );
+
     _layout_update_timer = new QTimer(this);
     _layout_update_timer->setSingleShot(true);
     connect( _layout_update_timer, &QTimer::timeout, this, &SidepanelReplay::onTimerUpdate );
 
 
+    // playback is driven at display rate, independently of the transitions density
     _play_timer = new QTimer(this);
-    _play_timer->setSingleShot(true);
+    _play_timer->setSingleShot(false);
     connect( _play_timer, &QTimer::timeout, this, &SidepanelReplay::onPlayUpdate );
 
+    for (double speed: {0.1, 0.25, 0.5, 1.0, 2.0, 5.0, 10.0, 25.0, 50.0, 100.0})
+    {
+        ui->comboBoxSpeed->addItem( QString("%1x").arg(speed), speed );
+    }
+    ui->comboBoxSpeed->setCurrentIndex( ui->comboBoxSpeed->findData(1.0) );
+
+    connect( this, &SidepanelReplay::loadChunkReady,
+             this, &SidepanelReplay::onLoadChunkReady, Qt::QueuedConnection );
+
+    // a logger writes many small blocks: read them once they settle
+    _follow_timer = new QTimer(this);
+    _follow_timer->setSingleShot(true);
+    connect( _follow_timer, &QTimer::timeout, this, &SidepanelReplay::onFollowUpdate );
+
+    _file_watcher = new QFileSystemWatcher(this);
+    connect( _file_watcher, &QFileSystemWatcher::fileChanged, this, [this]()
+    {
+        if( !_follow_timer->isActive() )
+        {
+            _follow_timer->start(50);
+        }
+    });
+
+    ui->progressBarLoad->setHidden(true);
+    ui->pushButtonCancelLoad->setHidden(true);
+
     ui->tableView->installEventFilter(this);
 }
 
 SidepanelReplay::~SidepanelReplay()
 {
+    cancelLoading();
     delete ui;
 }
 
 void SidepanelReplay::clear()
 {
-    _table_model->setColumnCount(4);
-    _table_model->setRowCount(0);
+    cancelLoading();
+    stopFollowing();
+    _decoder.reset();
+    ui->checkBoxFollow->setEnabled(false);
+
+    // unmaps the previous log, if any
+    _log_file.close();
+    _log_content.clear();
+
+    _transitions.clear();
+    _index.clear();
+    _stats.clear();
+    _timepoint.clear();
+    _checkpoints.clear();
+    _displayed_state.clear();
+    _prev_row = -1;
+    _table_model->reset();
+    updateTimeControls();
+
+    refreshStatistics();
+    if( ui->checkBoxHeatMap->isChecked() )
+    {
+        emit changeNodeHeat( "BehaviorTree", {} );
+    }
 }
 
-void SidepanelReplay::updateTableModel(const AbsBehaviorTree& locaded_tree)
+void SidepanelReplay::updateTimeControls()
 {
-    _table_model->setColumnCount(4);
-    _table_model->setRowCount(0);
+    const int timepoints = static_cast<int>(_timepoint.size());
+    const bool playing = ui->pushButtonPlay->isChecked();
 
-    const size_t transitions_count = _transitions.size();
+    ui->label->setText( QString("of %1").arg( timepoints ) );
 
-    auto createStatusItem = [](NodeStatus status) -> QStandardItem*
-    {
-        QStandardItem* item = nullptr;
-        switch (status)
-        {
-        case NodeStatus::SUCCESS:{
-            item = new QStandardItem("SUCCESS");
-            item->setBackground(QColor::fromRgb(22, 255, 22));
-        } break;
-        case NodeStatus::FAILURE:{
-            item = new QStandardItem("FAILURE");
-            item->setBackground(QColor::fromRgb(255, 22, 22));
-        } break;
-        case NodeStatus::RUNNING:{
-            item = new QStandardItem("RUNNING");
-            item->setBackground(QColor::fromRgb(160, 160, 250));
-        } break;
-        case NodeStatus::IDLE:{
-            item = new QStandardItem("IDLE");
-            item->setBackground(QColor::fromRgb(222, 222, 222));
-        } break;
-        }
-        item->setForeground(QColor::fromRgb(0, 0, 0));
-        return item;
-    };
+    ui->spinBox->setMaximum( std::max(0 , timepoints-1) );
+    ui->spinBox->setEnabled( timepoints > 0 && !playing );
+    ui->timeSlider->setMaximum( std::max(0 , timepoints-1) );
+    ui->timeSlider->setEnabled( timepoints > 0 && !playing );
+    ui->pushButtonPlay->setEnabled( timepoints > 0 );
+}
 
-    if(  transitions_count > 0)
+void SidepanelReplay::appendTransitions(const TransitionLog& chunk)
+{
+    if( chunk.empty() )
     {
-        double previous_timestamp = 0;
-        const double first_timestamp = _transitions.front().timestamp;
-
-        for(size_t row=0; row < transitions_count; row++)
-        {
-            auto& trans = _transitions[row];
-            auto node  = locaded_tree.node( trans.index );
+        return;
+    }
+    const size_t first_row = _transitions.size();
+    const bool first_chunk = (first_row == 0);
 
-            QString timestamp;
-            timestamp.sprintf("%.3f", trans.timestamp - first_timestamp);
+    _table_model->beginAppendRows( static_cast<int>(chunk.size()) );
+    _transitions.append( chunk );
+    _table_model->endAppendRows();
 
-            auto timestamp_item = new QStandardItem( timestamp );
-            timestamp.sprintf("absolute time: %.3f", trans.timestamp);
-            timestamp_item->setToolTip( timestamp );
+    _index.append( _transitions, first_row );
+    _stats.append( _transitions, first_row );
+    invalidateStatistics();
+    _checkpoints.append( _transitions, first_row );
 
-            if(  (trans.timestamp - previous_timestamp) >= 0.001 || row == transitions_count-1)
-            {
-                _timepoint.push_back( {trans.timestamp, row}  );
-                previous_timestamp = trans.timestamp;
+    double previous_timestamp = _timepoint.empty() ? 0 : _timepoint.back().first;
 
-                auto font = timestamp_item->font();
-                font.setBold(true);
-                timestamp_item->setFont(font);
-            }
+    const auto& timestamps = _transitions.timestamps();
 
-            QList<QStandardItem *> rowData;
-            rowData << timestamp_item;
-            rowData << new QStandardItem( node->instance_name );
-            rowData << createStatusItem( trans.prev_status );
-            rowData << createStatusItem( trans.status );
-            _table_model->appendRow(rowData);
+    for(size_t row = first_row; row < timestamps.size(); row++)
+    {
+        // the last row is added as well, once loading is finished
+        if(  (timestamps[row] - previous_timestamp) >= 0.001 )
+        {
+            _timepoint.push_back( {timestamps[row], row}  );
+            previous_timestamp = timestamps[row];
         }
+    }
 
-        emit _table_model->dataChanged( _table_model->index(0,0), _table_model->index( transitions_count-1, 3) );
+    if( _table_model->isFiltered() )
+    {
+        _table_model->appendVisibleRows(
+                    _index.find( _transitions, _filter_query, first_row, _transitions.size() ) );
+    }
 
+    if( first_chunk )
+    {
         ui->tableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
         ui->tableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
         ui->tableView->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
         ui->tableView->horizontalHeader()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
-        ui->tableView->verticalHeader()->minimumSize();
     }
 
-    ui->label->setText( QString("of %1").arg( _timepoint.size() ) );
-
-    ui->spinBox->setValue(0);
-    ui->spinBox->setMaximum( std::max(0 , (int)_timepoint.size()-1) );
-    ui->spinBox->setEnabled( !_timepoint.empty() );
-    ui->timeSlider->setValue( 0 );
-    ui->timeSlider->setMaximum( std::max(0 , (int)_timepoint.size()-1) );
-    ui->timeSlider->setEnabled( !_timepoint.empty() );
-    ui->pushButtonPlay->setEnabled( !_timepoint.empty() );
+    updateTimeControls();
 }
 
 void SidepanelReplay::on_LoadLog()
@@ -161,66 +599,131 @@ void SidepanelReplay::on_LoadLog()
     {
         return;
     }
-    QFile file(fileName);
-
-    if (!file.open(QIODevice::ReadOnly)){
+    if( !loadLogFile(fileName) )
+    {
         return;
     }
 
     directory_path = QFileInfo(fileName).absolutePath();
     settings.setValue("SidepanelReplay.lastLoadDirectory", directory_path);
     settings.sync();
+}
+
+bool SidepanelReplay::loadLogFile(const QString &filename)
+{
+    // the previous log may still be parsed: stop that before unmapping it
+    cancelLoading();
+    stopFollowing();
+    _log_file.close();
+    _log_content.clear();
+    _log_file.setFileName(filename);
+
+    if (!_log_file.open(QIODevice::ReadOnly)){
+        return false;
+    }
+
+    // Everything below uses this size: a logger may append records or
+    // truncate the file while it is being loaded.
+    const qint64 file_size = _log_file.size();
+
+    // The header is copied, so that only the transitions are read in place.
+    QByteArray header = _log_file.read(4);
+    if( header.size() == 4 )
+    {
+        const qint64 header_size = flatbuffers::ReadScalar<uint32_t>( header.constData() );
+        if( header_size <= file_size - 4 )
+        {
+            header.append( _log_file.read(header_size) );
+        }
+    }
 
-    QByteArray content = file.readAll();
-    loadLog( content );
+    FblLayout layout;
+    UidTable uid_to_index;
+    if( !loadLogHeader( header.constData(), size_t(header.size()), &layout, &uid_to_index ) )
+    {
+        _log_file.close();
+        return false;
+    }
+
+    // Map the file instead of reading it: no copy of the records lives on
+    // the heap, and the pages read by the worker can be dropped by the kernel.
+    // The decoded columns still take about 17 bytes per record (see startLoading).
+    // A followed file is read instead, because touching the mapped pages of
+    // a file truncated by its logger raises SIGBUS.
+    const uchar* mapped = nullptr;
+    if( !ui->checkBoxFollow->isChecked() )
+    {
+        mapped = _log_file.map(0, file_size);
+    }
+
+    if( mapped )
+    {
+        startLoading( RecordSource::MAPPED_FILE, reinterpret_cast<const char*>(mapped),
+                      layout.first_record, size_t(file_size), uid_to_index );
+    }
+    else{
+        startLoading( RecordSource::READ_FILE, nullptr,
+                      layout.first_record, size_t(file_size), uid_to_index );
+    }
+    return true;
 }
 
 void SidepanelReplay::loadLog(const QByteArray &content)
 {
-    const char* buffer = reinterpret_cast<const char*>(content.data());
+    cancelLoading();
+    stopFollowing();
+    // this log does not come from the file opened before, if any
+    _log_file.close();
+    // shared, not copied: the parsing thread reads it after we return
+    _log_content = content;
+    loadLog( _log_content.constData(), size_t(_log_content.size()) );
+}
 
-    // how many bytes did we read off the disk (uoffset_t aka uint32_t)
-    const auto read_bytes = content.size();
+void SidepanelReplay::loadLog(const char* buffer, size_t read_bytes)
+{
+    FblLayout layout;
+    UidTable uid_to_index;
+    if( loadLogHeader( buffer, read_bytes, &layout, &uid_to_index ) )
+    {
+        startLoading( RecordSource::MEMORY, buffer, layout.first_record, read_bytes, uid_to_index );
+    }
+}
 
-    // we need at least 4 bytes to read the bt_header_size
-    if( read_bytes < 4 ) {
+bool SidepanelReplay::loadLogHeader(const char* buffer, size_t size,
+                                    FblLayout* layout, UidTable* uid_to_index)
+{
+    cancelLoading();
+    stopFollowing();
+    _decoder.reset();
+    ui->checkBoxFollow->setEnabled(false);
+
+    switch( ParseFblLayout( buffer, size, layout ) )
+    {
+    case FblError::NONE: break;
+    case FblError::EMPTY:
         QMessageBox::warning( this, "Log file is empty",
                              "Failed to load this file.\n"
                              "This Log file is empty");
-        return;
-    }
-    
-    // read the length of the header section from the file
-    const size_t bt_header_size = flatbuffers::ReadScalar<uint32_t>(buffer);
-
-    // if the length of the header goes past the end of the file, it is invalid
-    if( (bt_header_size == 0) || (bt_header_size > read_bytes) ) {
+        return false;
+    case FblError::CORRUPT:
         QMessageBox::warning( this, "Log file is corrupt",
                              "Failed to load this file.\n"
                              "This Log file corrupted or truncated");
-        return;
-    }
-
-    flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(buffer+4),
-                                   size_t(content.size() -4));
-
-    bool valid_tree = Serialization::VerifyBehaviorTreeBuffer(verifier);
-    if( ! valid_tree )
-    {
+        return false;
+    case FblError::INCOMPATIBLE:
         QMessageBox::warning( this, "Flatbuffer verification failed",
                              "Failed to load this file.\n"
                              "Its format is not compatible with the current one");
-        return;
+        return false;
     }
 
-
     auto fb_behavior_tree = Serialization::GetBehaviorTree( &buffer[4] );
 
 
     auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
 
     _loaded_tree  = res_pair.first;
-    const auto& uid_to_index = res_pair.second;
+    *uid_to_index = res_pair.second;
 
     for (const auto& tree_node: _loaded_tree.nodes() )
     {
@@ -234,55 +737,438 @@ void SidepanelReplay::loadLog(const QByteArray &content)
     emit loadBehaviorTree( _loaded_tree, "BehaviorTree" );
 
     _transitions.clear();
-    _transitions.reserve( (content.size() - 4 - bt_header_size) / 12 );
 
-    int idle_counter = _loaded_tree.nodes().size();
+    _index.reset( _loaded_tree.nodesCount() );
+    _stats.reset( _loaded_tree.nodesCount() );
+    refreshStatistics();
+    _checkpoints.reset( _loaded_tree.nodesCount() );
+
+    _timepoint.clear();
+    _displayed_state.clear();
+    _prev_row = -1;
+    _table_model->reset();
+
+    // node indexes refer to the new tree now
+    on_lineEditFilter_textChanged( ui->lineEditFilter->text() );
+
+    {
+        QSignalBlocker block_spin( ui->spinBox );
+        QSignalBlocker block_Slider( ui->timeSlider );
+        ui->spinBox->setValue(0);
+        ui->timeSlider->setValue(0);
+    }
+    updateTimeControls();
+
+    // We need to lock the nodes after they are loaded
+    auto main_win = dynamic_cast<MainWindow*>( _parent );
+    main_win->lockEditing(true);
+
+    return true;
+}
+
+void SidepanelReplay::startLoading(RecordSource source, const char* buffer,
+                                   size_t first_offset, size_t read_bytes,
+                                   const UidTable& uid_to_index)
+{
+    // small first chunk, so that the first rows show up immediately
+    const size_t FIRST_CHUNK_SIZE = 1000;
+    const size_t CHUNK_SIZE = 100000;
+
+    _load_state.cancel = false;
+    _load_state.progress_percent = 0;
+    {
+        std::lock_guard<std::mutex> lock( _load_state.mutex );
+        _load_state.pending.clear();
+        _load_state.finished = false;
+        _load_state.truncated = false;
+        _load_state.end_offset = first_offset;
+        _load_state.error.clear();
+    }
+
+    _loading = true;
+    ui->progressBarLoad->setValue(0);
+    ui->progressBarLoad->setHidden(false);
+    ui->pushButtonCancelLoad->setHidden(false);
+
     const int total_nodes = _loaded_tree.nodes().size();
-    int nearest_restart_transition_index = 0;
 
-    for (size_t offset = 4+bt_header_size; offset < content.size(); offset += 12)
+    // a record truncated at the end of the file is ignored
+    const size_t total_records = (read_bytes - first_offset) / TransitionDecoder::RECORD_SIZE;
+
+    // Every record is decoded and kept in memory: about 13 bytes per row in
+    // _transitions and 4 in the rows of _index, plus the checkpoints. The heap
+    // grows with the log; only the raw records are left in the mapped file.
+    _transitions.reserve( total_records );
+
+    // owned by the worker until it has finished, then used to follow the file
+    _decoder.reset( new TransitionDecoder( uid_to_index, total_nodes ) );
+    TransitionDecoder* decoder = _decoder.get();
+
+    const QString filename = _log_file.fileName();
+
+    _load_future = QtConcurrent::run( [=]()
     {
-        Transition transition;
-        const double t_sec  = flatbuffers::ReadScalar<uint32_t>( &buffer[offset] );
-        const double t_usec = flatbuffers::ReadScalar<uint32_t>( &buffer[offset+4] );
-        double timestamp = t_sec + t_usec* 0.000001;
-        transition.timestamp = timestamp;
-        const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
-        transition.index = uid_to_index.at(uid);
-        transition.prev_status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+10] ));
-        transition.status      = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+11] ));
-        transition.is_tree_restart = false;
+        LoadState& state = _load_state;
+
+        TransitionLog chunk;
+        size_t chunk_size = FIRST_CHUNK_SIZE;
+        QString error;
+        bool truncated = false;
 
-        if(transition.index == 1 &&
-                (transition.status == NodeStatus::RUNNING || transition.status == NodeStatus::IDLE) &&
-                idle_counter >= total_nodes - 1){
-            transition.is_tree_restart = true;
-            nearest_restart_transition_index = _transitions.size();
+        auto publish = [&](size_t offset, bool finished)
+        {
+            {
+                std::lock_guard<std::mutex> lock( state.mutex );
+                state.pending.append( chunk );
+                state.finished = finished;
+                state.truncated = truncated;
+                state.end_offset = offset;
+                state.error = error;
+            }
+            state.progress_percent = static_cast<int>( (100.0 * offset) / read_bytes );
+            chunk.clear();
+            emit loadChunkReady();
+        };
+
+        // the file is opened again: _log_file belongs to the main thread
+        QFile file( filename );
+        if( source != RecordSource::MEMORY )
+        {
+            if( !file.open(QIODevice::ReadOnly) ||
+                ( source == RecordSource::READ_FILE && !file.seek( qint64(first_offset) ) ) )
+            {
+                error = QString("Can not read %1").arg( filename );
+                publish( first_offset, true );
+                return;
+            }
         }
 
-        if(transition.prev_status != NodeStatus::IDLE && transition.status == NodeStatus::IDLE)
-            idle_counter++;
-        else if(transition.prev_status == NodeStatus::IDLE && transition.status != NodeStatus::IDLE)
-            idle_counter--;
+        QByteArray read_buffer;
+        size_t row = 0;
+
+        while( row < total_records && !state.cancel )
+        {
+            size_t count = std::min( chunk_size, total_records - row );
+            const size_t offset = first_offset + row * TransitionDecoder::RECORD_SIZE;
+            const char* records = nullptr;
+
+            if( source == RecordSource::READ_FILE )
+            {
+                read_buffer = file.read( qint64(count * TransitionDecoder::RECORD_SIZE) );
+                records = read_buffer.constData();
+                if( size_t(read_buffer.size()) < count * TransitionDecoder::RECORD_SIZE )
+                {
+                    truncated = true;
+                    count = size_t(read_buffer.size()) / TransitionDecoder::RECORD_SIZE;
+                }
+            }
+            else
+            {
+                // the mapped pages past the end of a truncated file must not be touched
+                if( source == RecordSource::MAPPED_FILE &&
+                    file.size() < qint64(offset + count * TransitionDecoder::RECORD_SIZE) )
+                {
+                    truncated = true;
+                    break;
+                }
+                records = buffer + offset;
+            }
 
-        transition.nearest_restart_transition_index = nearest_restart_transition_index;
+            const size_t decoded = decoder->decode( records, count, chunk );
+            row += decoded;
+
+            if( decoded < count )
+            {
+                const uint16_t uid = flatbuffers::ReadScalar<uint16_t>( records + decoded*TransitionDecoder::RECORD_SIZE + 8 );
+                error = QString("Unknown node uid %1 in transition %2").arg(uid).arg(row);
+                break;
+            }
+            if( truncated )
+            {
+                break;
+            }
+            if( row < total_records )
+            {
+                publish( first_offset + row * TransitionDecoder::RECORD_SIZE, false );
+            }
+            chunk_size = CHUNK_SIZE;
+        }
+        publish( first_offset + row * TransitionDecoder::RECORD_SIZE, true );
+    });
+}
 
-        _transitions.push_back(transition);
+void SidepanelReplay::cancelLoading()
+{
+    if( !_loading )
+    {
+        return;
     }
+    _load_state.cancel = true;
+    _load_future.waitForFinished();
 
-    _timepoint.clear();
-    _prev_row = -1;
-    updateTableModel(_loaded_tree);
+    // whatever was decoded is dropped: the caller is about to reset the log
+    {
+        std::lock_guard<std::mutex> lock( _load_state.mutex );
+        _load_state.pending.clear();
+        _load_state.finished = false;
+    }
+    _loading = false;
+    ui->progressBarLoad->setHidden(true);
+    ui->pushButtonCancelLoad->setHidden(true);
+}
 
+void SidepanelReplay::onLoadChunkReady()
+{
+    if( !_loading )
+    {
+        return;
+    }
+    TransitionLog chunk;
+    bool finished = false;
+    bool truncated = false;
+    QString error;
+    {
+        std::lock_guard<std::mutex> lock( _load_state.mutex );
+        std::swap( chunk, _load_state.pending );
+        std::swap( finished, _load_state.finished );
+        truncated = _load_state.truncated;
+        error = _load_state.error;
+        _read_offset = _load_state.end_offset;
+    }
 
-    // We need to lock the nodes after they are loaded
-    auto main_win = dynamic_cast<MainWindow*>( _parent );
-    main_win->lockEditing(true);
+    appendTransitions( chunk );
+    ui->progressBarLoad->setValue( _load_state.progress_percent );
+
+    if( finished )
+    {
+        finishLoading( error, truncated );
+    }
+}
+
+void SidepanelReplay::finishLoading(const QString& error, bool truncated)
+{
+    _loading = false;
+    ui->progressBarLoad->setHidden(true);
+    ui->pushButtonCancelLoad->setHidden(true);
+
+    appendLastTimepoint();
+    updateTimeControls();
+
+    // the rest of a cancelled log is not read while following either
+    if( _load_state.cancel )
+    {
+        _decoder.reset();
+    }
+
+    if( !error.isEmpty() )
+    {
+        // the decoder stopped at an invalid record: there is nothing to follow
+        _decoder.reset();
+        QMessageBox::warning( this, "Log file is corrupt",
+                             QString("Failed to load part of this file.\n%1").arg(error) );
+    }
+    else if( truncated )
+    {
+        if( ui->checkBoxFollow->isChecked() )
+        {
+            // like in onFollowUpdate(): the logger started a new log in the same file
+            loadLogFile( _log_file.fileName() );
+            return;
+        }
+        _decoder.reset();
+        QMessageBox::warning( this, "Log file is truncated",
+                             "This file was truncated while it was loaded.\n"
+                             "Only the transitions read before are shown." );
+    }
+
+    ui->checkBoxFollow->setEnabled( _decoder && _log_file.isOpen() );
+    if( ui->checkBoxFollow->isChecked() )
+    {
+        startFollowing();
+    }
+}
+
+void SidepanelReplay::appendLastTimepoint()
+{
+    if( !_transitions.empty() )
+    {
+        const int last_row = static_cast<int>(_transitions.size()) - 1;
+        if( _timepoint.empty() || _timepoint.back().second != last_row )
+        {
+            _timepoint.push_back( {_transitions.timestamp(last_row), last_row} );
+        }
+    }
+}
+
+void SidepanelReplay::startFollowing()
+{
+    if( _loading || !_decoder || !_log_file.isOpen() )
+    {
+        return;
+    }
+    if( !_file_watcher->files().contains( _log_file.fileName() ) )
+    {
+        _file_watcher->addPath( _log_file.fileName() );
+    }
+    // records may have been written while the log was loading
+    onFollowUpdate();
+}
+
+void SidepanelReplay::stopFollowing()
+{
+    _follow_timer->stop();
+    if( !_file_watcher->files().isEmpty() )
+    {
+        _file_watcher->removePaths( _file_watcher->files() );
+    }
+}
+
+void SidepanelReplay::on_checkBoxFollow_toggled(bool checked)
+{
+    if( checked )
+    {
+        startFollowing();
+    }
+    else{
+        stopFollowing();
+    }
+}
+
+void SidepanelReplay::onFollowUpdate()
+{
+    if( _loading || !_decoder || !_log_file.isOpen() || !ui->checkBoxFollow->isChecked() )
+    {
+        return;
+    }
+
+    // a file replaced by a new one is not watched anymore
+    if( !_file_watcher->files().contains( _log_file.fileName() ) &&
+        QFileInfo::exists( _log_file.fileName() ) )
+    {
+        _file_watcher->addPath( _log_file.fileName() );
+    }
+
+    const qint64 file_size = QFileInfo( _log_file.fileName() ).size();
+    if( file_size < qint64(_read_offset) )
+    {
+        // truncated: the logger started a new log in the same file
+        loadLogFile( _log_file.fileName() );
+        return;
+    }
+
+    // a record still being written is read the next time
+    const size_t available = (size_t(file_size) - _read_offset) / TransitionDecoder::RECORD_SIZE;
+    if( available == 0 || !_log_file.seek( qint64(_read_offset) ) )
+    {
+        return;
+    }
+    const QByteArray records = _log_file.read( qint64(available * TransitionDecoder::RECORD_SIZE) );
+    const size_t count = size_t(records.size()) / TransitionDecoder::RECORD_SIZE;
+
+    TransitionLog chunk;
+    const size_t decoded = _decoder->decode( records.constData(), count, chunk );
+    _read_offset += decoded * TransitionDecoder::RECORD_SIZE;
+
+    // like "tail -f": keep showing the last transition, unless the user moved away
+    const bool at_last_row = ( _prev_row == static_cast<int>(_transitions.size()) - 1 );
+
+    appendTransitions( chunk );
+    appendLastTimepoint();
+    updateTimeControls();
+
+    if( at_last_row && !_transitions.empty() && !ui->pushButtonPlay->isChecked() )
+    {
+        const int last_row = static_cast<int>(_transitions.size()) - 1;
+        onRowChanged( last_row );
+        updatedSpinAndSlider( last_row );
+        scrollToRow( last_row, QAbstractItemView::EnsureVisible );
+    }
+
+    if( decoded < count )
+    {
+        const char* record = records.constData() + decoded * TransitionDecoder::RECORD_SIZE;
+        const uint16_t uid = flatbuffers::ReadScalar<uint16_t>( record + 8 );
+        _decoder.reset();
+        ui->checkBoxFollow->setChecked(false);
+        ui->checkBoxFollow->setEnabled(false);
+        QMessageBox::warning( this, "Log file is corrupt",
+                             QString("Stopped following this file.\nUnknown node uid %1 in transition %2")
+                             .arg(uid).arg(_transitions.size()) );
+    }
+}
+
+void SidepanelReplay::invalidateStatistics()
+{
+    _stats_dirty = true;
+    if( ui->tabWidgetReplay->currentWidget() == ui->tabStatistics ||
+        ui->checkBoxHeatMap->isChecked() )
+    {
+        refreshStatistics();
+    }
+}
+
+void SidepanelReplay::refreshStatistics()
+{
+    _stats_dirty = false;
+    _stats_model->refresh();
+    updateHeatMap();
+}
+
+void SidepanelReplay::updateHeatMap()
+{
+    if( !ui->checkBoxHeatMap->isChecked() || _stats.nodesCount() == 0 )
+    {
+        return;
+    }
+    std::vector<double> node_heat( _stats.nodesCount() );
+    double max_total = 0;
+    for (size_t index = 0; index < node_heat.size(); index++)
+    {
+        node_heat[index] = _stats.runningTotal(index);
+        max_total = std::max( max_total, node_heat[index] );
+    }
+    if( max_total > 0 )
+    {
+        for (double& heat: node_heat)
+        {
+            heat /= max_total;
+        }
+    }
+    emit changeNodeHeat( "BehaviorTree", node_heat );
+}
+
+void SidepanelReplay::on_checkBoxHeatMap_toggled(bool checked)
+{
+    if( checked )
+    {
+        refreshStatistics();
+    }
+    else{
+        emit changeNodeHeat( "BehaviorTree", {} );
+    }
 }
 
+void SidepanelReplay::on_tabWidgetReplay_currentChanged(int)
+{
+    if( _stats_dirty && ui->tabWidgetReplay->currentWidget() == ui->tabStatistics )
+    {
+        refreshStatistics();
+    }
+}
+
+void SidepanelReplay::on_pushButtonCancelLoad_clicked()
+{
+    // the worker publishes what it has decoded so far and stops
+    _load_state.cancel = true;
+}
 
 void SidepanelReplay::on_spinBox_valueChanged(int value)
 {
+    if( _timepoint.empty() )
+    {
+        return;
+    }
+
     if( ui->timeSlider->value() != value)
     {
         ui->timeSlider->setValue( value );
@@ -290,27 +1176,32 @@ void SidepanelReplay::on_spinBox_valueChanged(int value)
 
     int row = _timepoint[value].second;
 
-    ui->tableView->scrollTo( _table_model->index(row,0), QAbstractItemView::PositionAtCenter  );
+    scrollToRow( row, QAbstractItemView::PositionAtCenter );
 
     onRowChanged( row );
 }
 
 void SidepanelReplay::on_timeSlider_valueChanged(int value)
 {
+    if( _timepoint.empty() )
+    {
+        return;
+    }
+
     if( ui->spinBox->value() != value)
     {
         ui->spinBox->setValue( value );
     }
 
     int row = _timepoint[value].second;
-    ui->tableView->scrollTo( _table_model->index(row,0), QAbstractItemView::PositionAtCenter);
+    scrollToRow( row, QAbstractItemView::PositionAtCenter );
 
     onRowChanged( row );
 }
 
 void SidepanelReplay::onRowChanged(int current_row)
 {
-    current_row = std::min( current_row, _table_model->rowCount() -1 );
+    current_row = std::min( current_row, static_cast<int>(_transitions.size()) -1 );
     current_row = std::max( current_row, 0 );
 
     if( _prev_row == current_row)
@@ -324,19 +1215,7 @@ void SidepanelReplay::onRowChanged(int current_row)
     ui->tableView->horizontalHeader()->setSectionResizeMode (QHeaderView::Fixed);
     ui->tableView->verticalHeader()->setSectionResizeMode (QHeaderView::Fixed);
 
-    const auto selected_color   = QColor::fromRgb(210, 210, 210);
-    const auto unselected_color = QColor::fromRgb(255, 255, 255);
-
-    for (int row = std::max(0,_prev_row); row <= current_row; row++)
-    {
-        _table_model->item(row, 0)->setBackground( selected_color );
-        _table_model->item(row, 1)->setBackground( selected_color );
-    }
-    for (int row = current_row+1; row <= _prev_row; row++)
-    {
-        _table_model->item(row, 0)->setBackground( unselected_color );
-        _table_model->item(row, 1)->setBackground( unselected_color );
-    }
+    _table_model->setCurrentRow( current_row );
 
     // cancel the refresh of the layout refresh
     if( !_layout_update_timer->isActive() )
@@ -347,20 +1226,34 @@ void SidepanelReplay::onRowChanged(int current_row)
 
     const QString bt_name("BehaviorTree");
 
+    const TreeState state = _checkpoints.stateAtRow( _transitions, current_row );
+
+    // first update after loading: send every node
+    const bool full_refresh = ( _displayed_state.size() != state.size() );
+
     std::vector<std::pair<int, NodeStatus>>  node_status;
-    for(size_t index = 0; index < _loaded_tree.nodes().size(); index++ )
+    for(size_t index = 0; index < state.size(); index++ )
     {
-        node_status.push_back( { index, NodeStatus::IDLE} );
+        const NodeState& node_state = state[index];
+        if( !full_refresh && node_state == _displayed_state[index] )
+        {
+            continue;
+        }
+        // onChangeNodesStatus takes the previous status from the entries
+        // that precede in the same vector
+        if( node_state.prev_status != NodeStatus::IDLE )
+        {
+            node_status.push_back( { index, node_state.prev_status } );
+        }
+        node_status.push_back( { index, node_state.status } );
     }
+    _displayed_state = state;
 
-    for (int t = _transitions[current_row].nearest_restart_transition_index; t <= current_row; t++)
+    if( !node_status.empty() )
     {
-        auto& trans = _transitions[t];
-        node_status.push_back( { trans.index, trans.status} );
+        emit changeNodeStyle( bt_name, node_status, false );
     }
 
-    emit changeNodeStyle( bt_name, node_status, true );
-
     _prev_row = current_row;
 }
 
@@ -392,22 +1285,25 @@ bool SidepanelReplay::eventFilter(QObject *object, QEvent *event)
         {
             QKeyEvent *key_event = static_cast<QKeyEvent *>(event);
 
-            int next_row = -1;
+            // move to the next visible row; the current one may be filtered out
+            const int view_row = _table_model->viewRow( _prev_row );
+            int next_view_row = -1;
             if( key_event->key() ==  Qt::Key_Down)
             {
-                next_row = _prev_row +1;
+                next_view_row = view_row +1;
             }
             else if( key_event->key() ==  Qt::Key_Up)
             {
-                next_row = _prev_row -1;
+                const bool visible = view_row >= 0 && _table_model->sourceRow(view_row) == _prev_row;
+                next_view_row = visible ? view_row -1 : view_row;
             }
 
-            if( next_row >= 0 && next_row < _table_model->rowCount() )
+            if( next_view_row >= 0 && next_view_row < _table_model->rowCount() )
             {
+                const int next_row = _table_model->sourceRow( next_view_row );
                 onRowChanged( next_row);
                 updatedSpinAndSlider( next_row );
-                ui->tableView->scrollTo( _table_model->index(next_row,0),
-                                         QAbstractItemView::EnsureVisible);
+                scrollToRow( next_row, QAbstractItemView::EnsureVisible );
             }
             return true;
         }
@@ -420,8 +1316,18 @@ void SidepanelReplay::on_tableView_clicked(const QModelIndex &index)
     // disable during play
     if( !ui->pushButtonPlay->isChecked())
     {
-        onRowChanged( index.row() );
-        updatedSpinAndSlider( index.row() );
+        const int row = _table_model->sourceRow( index.row() );
+        onRowChanged( row );
+        updatedSpinAndSlider( row );
+    }
+}
+
+void SidepanelReplay::scrollToRow(int row, QAbstractItemView::ScrollHint hint)
+{
+    const int view_row = _table_model->viewRow( row );
+    if( view_row >= 0 )
+    {
+        ui->tableView->scrollTo( _table_model->index(view_row,0), hint );
     }
 }
 
@@ -438,70 +1344,196 @@ void SidepanelReplay::on_pushButtonPlay_toggled(bool checked)
     ui->timeSlider->setEnabled( !checked );
     ui->spinBox->setEnabled( !checked );
 
-    if(checked)
+    if(checked && !_transitions.empty())
     {
-        _next_row = std::max(0, _prev_row);
-        onPlayUpdate();
+        const int first_row = std::max(0, _prev_row);
+        _playback.start( _transitions, size_t(first_row) );
+        _play_clock.start();
+        onRowChanged( first_row );
+        updatedSpinAndSlider( first_row );
+        _play_timer->start( PLAY_FRAME_INTERVAL_MS );
     }
     else{
-        ui->tableView->scrollTo( _table_model->index( _prev_row,0),
-                                 QAbstractItemView::PositionAtCenter);
+        _play_timer->stop();
+        scrollToRow( _prev_row, QAbstractItemView::PositionAtCenter );
     }
 }
 
+double SidepanelReplay::playbackSpeed() const
+{
+    const double speed = ui->comboBoxSpeed->currentData().toDouble();
+    return (speed > 0) ? speed : 1.0;
+}
+
+// Called once per frame, see PlaybackClock
 void SidepanelReplay::onPlayUpdate()
 {
     if( !ui->pushButtonPlay->isChecked() || _transitions.empty() )
     {
+        _play_timer->stop();
         return;
-    }  
-
-    using namespace std::chrono;
-    const int LAST_ROW = _transitions.size()-1;
+    }
 
-    _next_row = std::max(0, _next_row);
-    _next_row = std::min(LAST_ROW, _next_row);
+    const int last_row = static_cast<int>(_transitions.size()) - 1;
+    const int row = static_cast<int>(
+                _playback.advance( _transitions, _play_clock.restart() * 0.001, playbackSpeed() ) );
 
-    const double TIME_DIFFERENCE_THRESHOLD = 0.01;
+    if( row != _prev_row )
+    {
+        onRowChanged( row );
+        updatedSpinAndSlider( row );
+        scrollToRow( row, QAbstractItemView::EnsureVisible );
+    }
 
-    // move forward as long as timestamp difference is small.
-    while( _next_row < LAST_ROW -1 &&
-           (_transitions[_next_row+1].timestamp - _transitions[_next_row].timestamp) < TIME_DIFFERENCE_THRESHOLD )
+    if( row == last_row )
     {
-        _next_row++;
+        ui->pushButtonPlay->setChecked(false);
     }
+}
 
-    onRowChanged( _next_row );
-    updatedSpinAndSlider( _next_row );
-    ui->tableView->scrollTo( _table_model->index(_next_row,0), QAbstractItemView::EnsureVisible  );
+static bool parseStatus(const QString& text, bool* any, NodeStatus* status)
+{
+    const QString name = text.toUpper();
+    *any = false;
+    if( name.isEmpty() || name == "*" ) { *any = true; }
+    else if( name == "IDLE" )    { *status = NodeStatus::IDLE; }
+    else if( name == "RUNNING" ) { *status = NodeStatus::RUNNING; }
+    else if( name == "SUCCESS" ) { *status = NodeStatus::SUCCESS; }
+    else if( name == "FAILURE" ) { *status = NodeStatus::FAILURE; }
+    else { return false; }
+    return true;
+}
 
-    if( _next_row == LAST_ROW)
+// Tokens separated by spaces, all of them must match:
+//   name            the node name contains "name"
+//   under:name      the node is "name" or one of its descendants
+//   PREV->STATUS    the transition; either side can be omitted, e.g. "->FAILURE"
+//   t:from..to      time (relative to the first transition); either bound can be omitted
+// Returns false if the filter is empty.
+bool SidepanelReplay::parseFilter(const QString &filter_text, TransitionIndex::Query *query) const
+{
+    const QStringList tokens = filter_text.split(' ', QString::SkipEmptyParts);
+    if( tokens.empty() )
     {
-        ui->pushButtonPlay->setChecked(false);
-        return;
+        return false;
     }
 
-    const double prev_time = _transitions[_next_row].timestamp;
-    const double next_time = _transitions[_next_row+1].timestamp;
-    int delay_relative = (next_time - prev_time) * 1000;
+    const size_t nodes_count = _loaded_tree.nodesCount();
+    std::vector<bool> node_matches( nodes_count, true );
+    bool any_node = true;
 
-    _next_row++;
-    //qDebug() << "delay_relative " << delay_relative << " next_row " << _next_row << "\n";
+    auto restrictNodes = [&](const std::vector<bool>& allowed)
+    {
+        for (size_t index=0; index < nodes_count; index++ )
+        {
+            node_matches[index] = node_matches[index] && allowed[index];
+        }
+        any_node = false;
+    };
 
-    _play_timer->start(delay_relative);
-}
+    const double first_timestamp = _transitions.empty() ? 0.0 : _transitions.timestamp(0);
 
-void SidepanelReplay::on_lineEditFilter_textChanged(const QString &filter_text)
-{
-    for (int row=0; row < _table_model->rowCount(); row++ )
+    for (const QString& token: tokens)
     {
-        bool show = _table_model->item(row,1)->text().contains(filter_text, Qt::CaseInsensitive);
+        if( token.startsWith("under:", Qt::CaseInsensitive) )
+        {
+            const QString parent_name = token.mid(6);
+            std::vector<bool> in_subtree( nodes_count, false );
+            std::vector<int> pending;
+            for (size_t index=0; index < nodes_count; index++ )
+            {
+                if( _loaded_tree.node(index)->instance_name.compare(parent_name, Qt::CaseInsensitive) == 0 )
+                {
+                    pending.push_back( static_cast<int>(index) );
+                }
+            }
+            while( !pending.empty() )
+            {
+                const int index = pending.back();
+                pending.pop_back();
+                if( in_subtree[index] )
+                {
+                    continue;
+                }
+                in_subtree[index] = true;
+                for (int child: _loaded_tree.node(index)->children_index)
+                {
+                    pending.push_back( child );
+                }
+            }
+            restrictNodes( in_subtree );
+            continue;
+        }
+
+        if( token.startsWith("t:", Qt::CaseInsensitive) && token.contains("..") )
+        {
+            const QString range = token.mid(2);
+            const int separator = range.indexOf("..");
+            const QString from = range.left(separator);
+            const QString to = range.mid(separator + 2);
+            bool from_ok = true;
+            bool to_ok = true;
+            const double from_time = from.isEmpty() ? 0.0 : from.toDouble(&from_ok);
+            const double to_time = to.isEmpty() ? 0.0 : to.toDouble(&to_ok);
+
+            if( from_ok && to_ok )
+            {
+                if( !from.isEmpty() ) { query->min_time = first_timestamp + from_time; }
+                if( !to.isEmpty() )   { query->max_time = first_timestamp + to_time; }
+                continue;
+            }
+        }
 
-        if( show ){
-            ui->tableView->showRow(row);
+        if( token.contains("->") )
+        {
+            const int separator = token.indexOf("->");
+            TransitionIndex::Query transition;
+            if( parseStatus( token.left(separator), &transition.any_prev_status, &transition.prev_status ) &&
+                parseStatus( token.mid(separator + 2), &transition.any_status, &transition.status ) )
+            {
+                query->any_prev_status = transition.any_prev_status;
+                query->prev_status = transition.prev_status;
+                query->any_status = transition.any_status;
+                query->status = transition.status;
+                continue;
+            }
         }
-        else{
-            ui->tableView->hideRow(row);
+
+        // anything else is part of a node name
+        std::vector<bool> name_matches( nodes_count );
+        for (size_t index=0; index < nodes_count; index++ )
+        {
+            name_matches[index] = _loaded_tree.node(index)->instance_name.contains(token, Qt::CaseInsensitive);
         }
+        restrictNodes( name_matches );
+    }
+
+    query->any_node = any_node;
+    query->nodes.clear();
+    if( !any_node )
+    {
+        for (size_t index=0; index < nodes_count; index++ )
+        {
+            if( node_matches[index] )
+            {
+                query->nodes.push_back( static_cast<int>(index) );
+            }
+        }
+    }
+    return true;
+}
+
+void SidepanelReplay::on_lineEditFilter_textChanged(const QString &filter_text)
+{
+    TransitionIndex::Query query;
+
+    if( !parseFilter( filter_text, &query ) )
+    {
+        _table_model->clearFilter();
+    }
+    else{
+        _filter_query = query;
+        _table_model->setFilter( _index.find( _transitions, _filter_query, 0, _transitions.size() ) );
     }
+    scrollToRow( _prev_row, QAbstractItemView::PositionAtCenter );
 }
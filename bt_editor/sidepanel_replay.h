@@ -2,12 +2,25 @@
 #define SIDEPANEL_REPLAY_H
 
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <memory>
 #include <QFrame>
-#include <QTableWidgetItem>
-#include <QStandardItemModel>
+#include <QFuture>
+#include <QFile>
+#include <QAbstractTableModel>
+#include <QAbstractItemView>
+#include <QFont>
+#include <QElapsedTimer>
 #include "bt_editor_base.h"
+#include "fbl_log.h"
+#include "transition_log.h"
+#include "transition_stats.h"
+#include "transition_history.h"
 
 
+class QFileSystemWatcher;
+
 namespace Ui {
 class SidepanelReplay;
 }
@@ -24,8 +37,16 @@ public:
 
     void loadLog(const QByteArray& content);
 
+    // the transitions are memory mapped (or read, when followed) and the
+    // file can be followed while it grows; false if it can't be opened or
+    // its header is rejected
+    bool loadLogFile(const QString& filename);
+
     size_t transitionsCount() const { return _transitions.size(); }
 
+    // true while the transitions are still being parsed in the background
+    bool isLoading() const { return _loading; }
+
 public slots:
 
     void on_LoadLog();
@@ -46,6 +67,18 @@ private slots:
 
     void on_lineEditFilter_textChanged(const QString &filter_text);
 
+    void on_pushButtonCancelLoad_clicked();
+
+    void onLoadChunkReady();
+
+    void on_checkBoxHeatMap_toggled(bool checked);
+
+    void on_tabWidgetReplay_currentChanged(int index);
+
+    void on_checkBoxFollow_toggled(bool checked);
+
+    void onFollowUpdate();
+
 signals:
     void loadBehaviorTree(const AbsBehaviorTree& tree, const QString& name );
 
@@ -55,33 +88,75 @@ signals:
 
     void addNewModel(const NodeModel &new_model);
 
+    void changeNodeHeat(const QString& bt_name, const std::vector<double>& node_heat);
+
+    // emitted by the parsing thread, queued to onLoadChunkReady()
+    void loadChunkReady();
+
 private:
 
     bool eventFilter(QObject *object, QEvent *event) override;
 
     void loadFromFlatbuffers(const std::vector<int8_t>& serialized_description);
 
+    // the worker reads buffer after this returns: it must outlive the load
+    void loadLog(const char* buffer, size_t size);
+
     void onRowChanged(int value);
 
     Ui::SidepanelReplay *ui;
 
-    struct Transition{
-        int16_t index;
-        double timestamp;
-        NodeStatus prev_status;
-        NodeStatus status;
-        bool is_tree_restart;
-        int nearest_restart_transition_index;
-    };
-    std::vector<Transition> _transitions;
+    class TableModel;
+
+    TransitionLog _transitions;
     std::vector< std::pair<double,int>> _timepoint;
 
+    // built while loading; answers the queries typed in lineEditFilter
+    TransitionIndex _index;
+    TransitionIndex::Query _filter_query;
+
+    bool parseFilter(const QString& filter_text, TransitionIndex::Query* query) const;
+
+    // scroll to a row of _transitions, or to the closest visible row before it
+    void scrollToRow(int row, QAbstractItemView::ScrollHint hint);
+
+    class StatsModel;
+
+    // per-node statistics, updated as the transitions are loaded
+    TransitionStats _stats;
+    StatsModel* _stats_model;
+    bool _stats_dirty;
+
+    // refresh the statistics now if they are visible, otherwise when they are shown
+    void invalidateStatistics();
+
+    void refreshStatistics();
+
+    // total RUNNING time of each node, relative to the slowest one
+    void updateHeatMap();
+
+    typedef TransitionCheckpoints::NodeState NodeState;
+    typedef TransitionCheckpoints::TreeState TreeState;
+
+    // state of the tree at any row, for seeking
+    TransitionCheckpoints _checkpoints;
+
+    // what has been sent with changeNodeStyle, to emit only the differences
+    TreeState _displayed_state;
+
     int _prev_row;
-    int _next_row;
+
+    static const int PLAY_FRAME_INTERVAL_MS = 16;
+
+    // position of the playback in the log, and the wall time of the last frame
+    PlaybackClock _playback;
+    QElapsedTimer _play_clock;
+
+    double playbackSpeed() const;
 
     void updatedSpinAndSlider(int row);
 
-    QStandardItemModel* _table_model;
+    TableModel* _table_model;
 
     QTimer *_layout_update_timer;
 
@@ -89,7 +164,61 @@ private:
 
     AbsBehaviorTree _loaded_tree;
 
-    void updateTableModel(const AbsBehaviorTree &tree);
+    // the log file stays open (and memory mapped) while it is being replayed
+    QFile _log_file;
+
+    // keeps alive the buffer passed to loadLog(const QByteArray&)
+    QByteArray _log_content;
+
+    // Transitions are decoded by a worker thread and handed over in chunks.
+    struct LoadState{
+        std::mutex mutex;
+        TransitionLog pending;
+        bool finished = false;
+        bool truncated = false;
+        size_t end_offset = 0;
+        QString error;
+        std::atomic<int> progress_percent{0};
+        std::atomic<bool> cancel{false};
+    };
+    LoadState _load_state;
+    QFuture<void> _load_future;
+    bool _loading;
+
+    // where the worker finds the transitions; MAPPED_FILE and READ_FILE use _log_file
+    enum class RecordSource { MEMORY, MAPPED_FILE, READ_FILE };
+
+    // checks the header, loads the tree and resets the transitions
+    bool loadLogHeader(const char* buffer, size_t size,
+                       FblLayout* layout, UidTable* uid_to_index);
+
+    void startLoading(RecordSource source, const char* buffer,
+                      size_t first_offset, size_t read_bytes,
+                      const UidTable& uid_to_index);
+
+    // stop the worker and wait for it; it must not outlive the buffer it reads
+    void cancelLoading();
+
+    void appendTransitions(const TransitionLog& chunk);
+
+    // a truncated file is loaded again when followed
+    void finishLoading(const QString& error, bool truncated);
+
+    // the last transition is always a timepoint
+    void appendLastTimepoint();
+
+    // Follow mode: the records appended to _log_file after loading are decoded
+    // by the same decoder, starting at _read_offset.
+    std::unique_ptr<TransitionDecoder> _decoder;
+    size_t _read_offset;
+    QFileSystemWatcher* _file_watcher;
+    QTimer* _follow_timer;
+
+    void startFollowing();
+
+    void stopFollowing();
+
+    void updateTimeControls();
 
     QWidget *_parent;
 };
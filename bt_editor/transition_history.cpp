@@ -0,0 +1,162 @@
+#include "transition_history.h"
+
+#include <algorithm>
+#include <cstring>
+
+//---------------------------------------------------
+
+void TransitionCheckpoints::clear()
+{
+    _checkpoints.clear();
+    _initial_state.clear();
+    _last_state.clear();
+}
+
+void TransitionCheckpoints::reset(size_t nodes_count, const TreeState &initial_state)
+{
+    // keep the snapshots smaller than the transitions themselves
+    _interval = std::max<size_t>( 1024, 4 * nodes_count );
+
+    _checkpoints.clear();
+    if( initial_state.size() == nodes_count )
+    {
+        _initial_state = initial_state;
+    }
+    else{
+        _initial_state.assign( nodes_count, {NodeStatus::IDLE, NodeStatus::IDLE} );
+    }
+    _last_state = _initial_state;
+}
+
+void TransitionCheckpoints::append(const TransitionLog &log, size_t first_row)
+{
+    for (size_t row = first_row; row < log.size(); row++)
+    {
+        if( row % _interval == 0 )
+        {
+            _checkpoints.push_back( _last_state );
+        }
+        applyTransition( log, _last_state, row );
+    }
+}
+
+void TransitionCheckpoints::applyTransition(const TransitionLog &log, TreeState &state, size_t row)
+{
+    if( log.isTreeRestart(row) )
+    {
+        std::fill( state.begin(), state.end(), NodeState{NodeStatus::IDLE, NodeStatus::IDLE} );
+    }
+    NodeState& node_state = state[ log.nodeIndex(row) ];
+    node_state.prev_status = node_state.status;
+    node_state.status = log.status(row);
+}
+
+TransitionCheckpoints::TreeState TransitionCheckpoints::stateAtRow(const TransitionLog &log, size_t row) const
+{
+    const size_t checkpoint = row / _interval;
+    size_t first_row = checkpoint * _interval;
+
+    TreeState state;
+    const size_t restart_row = log.nearestRestart(row);
+
+    // the tree was restarted after the checkpoint: everything was IDLE there
+    if( restart_row > first_row )
+    {
+        state.assign( _initial_state.size(), {NodeStatus::IDLE, NodeStatus::IDLE} );
+        first_row = restart_row;
+    }
+    else{
+        state = _checkpoints[checkpoint];
+    }
+
+    for (size_t t = first_row; t <= row; t++)
+    {
+        applyTransition( log, state, t );
+    }
+    return state;
+}
+
+//---------------------------------------------------
+
+void PlaybackClock::start(const TransitionLog &log, size_t row)
+{
+    _row = std::min( row, log.size() - 1 );
+    _time = log.timestamp( _row );
+}
+
+size_t PlaybackClock::advance(const TransitionLog &log, double elapsed, double speed)
+{
+    _time += elapsed * speed;
+
+    const size_t last_row = log.size() - 1;
+    const size_t due = log.upperBound( _time );
+    _row = std::min( std::max( _row, (due > 0) ? due - 1 : 0 ), last_row );
+
+    if( _row < last_row )
+    {
+        // skip idle gaps
+        const double next_time = log.timestamp( _row + 1 );
+        if( (next_time - _time) > MAX_IDLE_WAIT * speed )
+        {
+            _time = next_time - MAX_IDLE_WAIT * speed;
+        }
+    }
+    return _row;
+}
+
+//---------------------------------------------------
+
+TransitionRing::TransitionRing(size_t capacity):
+    _buffer( std::max<size_t>(capacity, 1) * TransitionDecoder::RECORD_SIZE ),
+    _capacity( std::max<size_t>(capacity, 1) ),
+    _writing( 0 ),
+    _written( 0 )
+{
+}
+
+void TransitionRing::push(const char *records, size_t count)
+{
+    const size_t RECORD_SIZE = TransitionDecoder::RECORD_SIZE;
+    // older records would be overwritten by the same push anyway
+    if( count > _capacity )
+    {
+        records += (count - _capacity) * RECORD_SIZE;
+        count = _capacity;
+    }
+    const uint64_t head = _written.load( std::memory_order_relaxed );
+    _writing.store( head + count, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    const size_t first_slot = head % _capacity;
+    const size_t first_part = std::min( count, _capacity - first_slot );
+    std::memcpy( &_buffer[first_slot * RECORD_SIZE], records, first_part * RECORD_SIZE );
+    std::memcpy( &_buffer[0], records + first_part * RECORD_SIZE, (count - first_part) * RECORD_SIZE );
+
+    _written.store( head + count, std::memory_order_release );
+}
+
+std::vector<char> TransitionRing::copy() const
+{
+    const size_t RECORD_SIZE = TransitionDecoder::RECORD_SIZE;
+
+    const uint64_t end = _written.load( std::memory_order_acquire );
+    const uint64_t begin = (end > _capacity) ? end - _capacity : 0;
+
+    std::vector<char> records( size_t(end - begin) * RECORD_SIZE );
+    for (uint64_t record = begin; record < end; record++)
+    {
+        std::memcpy( &records[ size_t(record - begin) * RECORD_SIZE ],
+                     &_buffer[ size_t(record % _capacity) * RECORD_SIZE ], RECORD_SIZE );
+    }
+
+    // the records the writer started to overwrite in the meantime are not valid
+    std::atomic_thread_fence( std::memory_order_acquire );
+    const uint64_t writing = _writing.load( std::memory_order_acquire );
+    const uint64_t first_valid = (writing > _capacity) ? writing - _capacity : 0;
+    if( first_valid > begin )
+    {
+        const size_t dropped = size_t( std::min(first_valid, end) - begin );
+        records.erase( records.begin(), records.begin() + dropped * RECORD_SIZE );
+    }
+    return records;
+}
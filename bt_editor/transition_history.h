@@ -0,0 +1,107 @@
+#ifndef TRANSITION_HISTORY_H
+#define TRANSITION_HISTORY_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "transition_log.h"
+
+// Status of every node at any row of a TransitionLog.
+// _checkpoints[k] is the TreeState before row k*interval is applied:
+// seeking restores one checkpoint and applies at most interval transitions.
+class TransitionCheckpoints
+{
+public:
+    // status of a node as shown in the tree. The style depends on the
+    // previous status too (a node that went back to IDLE keeps a faded color).
+    struct NodeState{
+        NodeStatus status;
+        NodeStatus prev_status;
+
+        bool operator ==(const NodeState& other) const {
+            return status == other.status && prev_status == other.prev_status;
+        }
+        bool operator !=(const NodeState& other) const { return !(*this == other); }
+    };
+    typedef std::vector<NodeState> TreeState;
+
+    TransitionCheckpoints(): _interval(1) {}
+
+    void clear();
+
+    // initial_state is the state before the first row; every node is IDLE if empty
+    void reset(size_t nodes_count, const TreeState& initial_state = TreeState());
+
+    // add the checkpoints of the rows [first_row, log.size()). Rows must be appended in order.
+    void append(const TransitionLog& log, size_t first_row);
+
+    // state after row is applied
+    TreeState stateAtRow(const TransitionLog& log, size_t row) const;
+
+    static void applyTransition(const TransitionLog& log, TreeState& state, size_t row);
+
+private:
+    std::vector<TreeState> _checkpoints;
+    size_t _interval;
+    TreeState _initial_state;
+
+    // running state at the end of the log, used to append checkpoints
+    TreeState _last_state;
+};
+
+// Position of the playback of a TransitionLog, advanced once per frame:
+// the log clock moves by the elapsed wall time multiplied by the speed, and
+// the row shown is the last transition due. All the transitions due since the
+// previous frame are applied at once, whatever their density.
+class PlaybackClock
+{
+public:
+    PlaybackClock(): _time(0), _row(0) {}
+
+    // never wait longer than this (wall time) for the next transition
+    static constexpr double MAX_IDLE_WAIT = 0.5;
+
+    // the log must not be empty
+    void start(const TransitionLog& log, size_t row);
+
+    // the row to show after elapsed seconds of wall time; it never goes back
+    size_t advance(const TransitionLog& log, double elapsed, double speed);
+
+    // absolute timestamp
+    double time() const { return _time; }
+
+    size_t row() const { return _row; }
+
+private:
+    double _time;
+    size_t _row;
+};
+
+// Fixed size ring of the newest 12 bytes records of a stream, allocated once.
+// A single thread pushes; any other thread can copy the content at any time.
+// The writer never waits for a reader: a reader that is overtaken while
+// copying drops the records that were overwritten.
+class TransitionRing
+{
+public:
+    explicit TransitionRing(size_t capacity);
+
+    size_t capacity() const { return _capacity; }
+
+    // writer thread only
+    void push(const char* records, size_t count);
+
+    // the newest records, oldest first
+    std::vector<char> copy() const;
+
+private:
+    std::vector<char> _buffer;
+    size_t _capacity;
+    // records pushed so far: _writing is advanced before a push, _written after
+    std::atomic<uint64_t> _writing;
+    std::atomic<uint64_t> _written;
+};
+
+#endif // TRANSITION_HISTORY_H
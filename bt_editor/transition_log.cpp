@@ -0,0 +1,307 @@
+#include "transition_log.h"
+
+#include <array>
+#include <algorithm>
+#include <numeric>
+
+//---------------------------------------------------
+
+void TransitionLog::clear()
+{
+    _timestamps.clear();
+    _node_index.clear();
+    _prev_status.clear();
+    _status.clear();
+    _is_restart.clear();
+    _restart_rows.clear();
+}
+
+void TransitionLog::reserve(size_t count)
+{
+    _timestamps.reserve(count);
+    _node_index.reserve(count);
+    _prev_status.reserve(count);
+    _status.reserve(count);
+    _is_restart.reserve(count);
+}
+
+void TransitionLog::append(const TransitionLog &other)
+{
+    const uint32_t offset = static_cast<uint32_t>( size() );
+
+    _timestamps.insert( _timestamps.end(), other._timestamps.begin(), other._timestamps.end() );
+    _node_index.insert( _node_index.end(), other._node_index.begin(), other._node_index.end() );
+    _prev_status.insert( _prev_status.end(), other._prev_status.begin(), other._prev_status.end() );
+    _status.insert( _status.end(), other._status.begin(), other._status.end() );
+    _is_restart.insert( _is_restart.end(), other._is_restart.begin(), other._is_restart.end() );
+
+    for (uint32_t row: other._restart_rows)
+    {
+        _restart_rows.push_back( row + offset );
+    }
+}
+
+size_t TransitionLog::nearestRestart(size_t row) const
+{
+    auto it = std::upper_bound( _restart_rows.begin(), _restart_rows.end(), row );
+    if( it == _restart_rows.begin() )
+    {
+        return 0;
+    }
+    return *(it - 1);
+}
+
+size_t TransitionLog::lowerBound(double timestamp) const
+{
+    return std::lower_bound( _timestamps.begin(), _timestamps.end(), timestamp ) - _timestamps.begin();
+}
+
+size_t TransitionLog::upperBound(double timestamp) const
+{
+    return std::upper_bound( _timestamps.begin(), _timestamps.end(), timestamp ) - _timestamps.begin();
+}
+
+//---------------------------------------------------
+
+// Serialization::NodeStatus (one byte on disk) -> BT::NodeStatus
+static const std::array<uint8_t, 256>& StatusTable()
+{
+    static const std::array<uint8_t, 256> table = []()
+    {
+        std::array<uint8_t, 256> values;
+        for (int i = 0; i < 256; i++)
+        {
+            auto fb_status = static_cast<Serialization::NodeStatus>( static_cast<int8_t>(i) );
+            values[i] = static_cast<uint8_t>( convert(fb_status) );
+        }
+        return values;
+    }();
+    return table;
+}
+
+TransitionDecoder::TransitionDecoder(const UidTable &uid_table, int total_nodes):
+    _uid_table( uid_table ),
+    _total_nodes( total_nodes ),
+    _idle_counter( total_nodes ),
+    _restart_rule( RestartRule::IDLE_TREE )
+{
+}
+
+size_t TransitionDecoder::decode(const char *records, size_t count, TransitionLog &log)
+{
+    const size_t first_row = log.size();
+    const size_t total_rows = first_row + count;
+
+    log._timestamps.resize( total_rows );
+    log._node_index.resize( total_rows );
+    log._prev_status.resize( total_rows );
+    log._status.resize( total_rows );
+    log._is_restart.resize( total_rows );
+
+    double*  timestamps  = log._timestamps.data()  + first_row;
+    int16_t* node_index  = log._node_index.data()  + first_row;
+    uint8_t* prev_status = log._prev_status.data() + first_row;
+    uint8_t* status      = log._status.data()      + first_row;
+    uint8_t* is_restart  = log._is_restart.data()  + first_row;
+
+    const int16_t* uid_table = _uid_table.data();
+    const uint8_t* status_table = StatusTable().data();
+
+    // First pass: fixed stride, no branches; the compiler can vectorize it.
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* record = records + i * RECORD_SIZE;
+        const double t_sec  = flatbuffers::ReadScalar<uint32_t>( record );
+        const double t_usec = flatbuffers::ReadScalar<uint32_t>( record + 4 );
+        timestamps[i]  = t_sec + t_usec * 0.000001;
+        node_index[i]  = uid_table[ flatbuffers::ReadScalar<uint16_t>( record + 8 ) ];
+        prev_status[i] = status_table[ static_cast<uint8_t>( record[10] ) ];
+        status[i]      = status_table[ static_cast<uint8_t>( record[11] ) ];
+    }
+
+    // Second pass: validation and restart detection depend on the previous rows.
+    size_t decoded = 0;
+    for (; decoded < count; decoded++)
+    {
+        const int index = node_index[decoded];
+        if( index < 0 || index >= _total_nodes )
+        {
+            break;
+        }
+        const auto prev = static_cast<NodeStatus>( prev_status[decoded] );
+        const auto curr = static_cast<NodeStatus>( status[decoded] );
+
+        const bool restart = ( _restart_rule == RestartRule::ROOT_RUNNING ) ?
+                             ( index == 1 && curr == NodeStatus::RUNNING ) :
+                             ( index == 1 &&
+                               (curr == NodeStatus::RUNNING || curr == NodeStatus::IDLE) &&
+                               _idle_counter >= _total_nodes - 1 );
+        is_restart[decoded] = restart;
+        if( restart )
+        {
+            log._restart_rows.push_back( static_cast<uint32_t>(first_row + decoded) );
+        }
+
+        if(prev != NodeStatus::IDLE && curr == NodeStatus::IDLE)
+            _idle_counter++;
+        else if(prev == NodeStatus::IDLE && curr != NodeStatus::IDLE)
+            _idle_counter--;
+    }
+
+    if( decoded < count )
+    {
+        log._timestamps.resize( first_row + decoded );
+        log._node_index.resize( first_row + decoded );
+        log._prev_status.resize( first_row + decoded );
+        log._status.resize( first_row + decoded );
+        log._is_restart.resize( first_row + decoded );
+    }
+    return decoded;
+}
+
+size_t TransitionDecoder::decodeStatus(const char *records, size_t count,
+                                       std::vector<std::pair<int, NodeStatus>> &node_status) const
+{
+    node_status.resize( count );
+    const uint8_t* status_table = StatusTable().data();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* record = records + i * STATUS_RECORD_SIZE;
+        const int index = _uid_table.indexOf( flatbuffers::ReadScalar<uint16_t>( record ) );
+        if( index < 0 || index >= _total_nodes )
+        {
+            node_status.resize( i );
+            return i;
+        }
+        node_status[i] = { index, static_cast<NodeStatus>( status_table[ static_cast<uint8_t>( record[2] ) ] ) };
+    }
+    return count;
+}
+
+//---------------------------------------------------
+
+void TransitionIndex::reset(size_t nodes_count)
+{
+    _rows.clear();
+    _rows.resize( nodes_count * STATUS_COUNT );
+}
+
+void TransitionIndex::append(const TransitionLog &log, size_t first_row)
+{
+    const auto& node_index = log.nodeIndexes();
+
+    for (size_t row = first_row; row < log.size(); row++)
+    {
+        const size_t list = node_index[row] * STATUS_COUNT + static_cast<int>( log.status(row) );
+        if( list < _rows.size() )
+        {
+            _rows[list].push_back( static_cast<uint32_t>(row) );
+        }
+    }
+}
+
+std::vector<uint32_t> TransitionIndex::find(const TransitionLog &log, const Query &query,
+                                            size_t first_row, size_t last_row) const
+{
+    std::vector<uint32_t> result;
+
+    first_row = std::max( first_row, log.lowerBound( query.min_time ) );
+    last_row  = std::min( last_row,  log.upperBound( query.max_time ) );
+    if( first_row >= last_row )
+    {
+        return result;
+    }
+
+    // no node nor status to look up: the rows of the range, in order
+    if( query.any_node && query.any_status )
+    {
+        if( query.any_prev_status )
+        {
+            result.resize( last_row - first_row );
+            std::iota( result.begin(), result.end(), uint32_t(first_row) );
+            return result;
+        }
+        for (size_t row = first_row; row < last_row; row++)
+        {
+            if( log.prevStatus(row) == query.prev_status )
+            {
+                result.push_back( uint32_t(row) );
+            }
+        }
+        return result;
+    }
+
+    // the part of each list of rows within the range
+    typedef std::pair<std::vector<uint32_t>::const_iterator,
+                      std::vector<uint32_t>::const_iterator> RowRange;
+    std::vector<RowRange> ranges;
+
+    auto collect = [&](const std::vector<uint32_t>& rows)
+    {
+        auto it  = std::lower_bound( rows.begin(), rows.end(), first_row );
+        auto end = std::lower_bound( it, rows.end(), last_row );
+        if( it != end )
+        {
+            ranges.push_back( { it, end } );
+        }
+    };
+
+    const int nodes_count = static_cast<int>( _rows.size() / STATUS_COUNT );
+
+    auto collectNode = [&](int node)
+    {
+        if( node < 0 || node >= nodes_count )
+        {
+            return;
+        }
+        if( !query.any_status )
+        {
+            collect( rows(node, query.status) );
+            return;
+        }
+        for (int status = 0; status < STATUS_COUNT; status++)
+        {
+            collect( rows(node, static_cast<NodeStatus>(status)) );
+        }
+    };
+
+    if( query.any_node )
+    {
+        for (int node = 0; node < nodes_count; node++)
+        {
+            collectNode( node );
+        }
+    }
+    else{
+        for (int node: query.nodes)
+        {
+            collectNode( node );
+        }
+    }
+
+    // each list is sorted: k-way merge, smallest row first
+    auto later = [](const RowRange& a, const RowRange& b) { return *a.first > *b.first; };
+    std::make_heap( ranges.begin(), ranges.end(), later );
+    while( !ranges.empty() )
+    {
+        std::pop_heap( ranges.begin(), ranges.end(), later );
+        RowRange& range = ranges.back();
+        const uint32_t row = *range.first++;
+
+        // a node may be listed twice in the query
+        if( (result.empty() || result.back() != row) &&
+            (query.any_prev_status || log.prevStatus(row) == query.prev_status) )
+        {
+            result.push_back( row );
+        }
+        if( range.first == range.second )
+        {
+            ranges.pop_back();
+        }
+        else{
+            std::push_heap( ranges.begin(), ranges.end(), later );
+        }
+    }
+    return result;
+}
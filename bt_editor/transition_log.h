@@ -0,0 +1,162 @@
+#ifndef TRANSITION_LOG_H
+#define TRANSITION_LOG_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <limits>
+
+#include "bt_editor_base.h"
+
+// Transitions of a .fbl log, stored column by column.
+// A transition takes 13 bytes instead of the 32 of a padded struct,
+// and a scan over a single field (e.g. the timestamps) stays in cache.
+class TransitionLog
+{
+public:
+    TransitionLog() {}
+
+    size_t size() const { return _timestamps.size(); }
+
+    bool empty() const { return _timestamps.empty(); }
+
+    void clear();
+
+    void reserve(size_t count);
+
+    // append the rows of another log (typically a chunk just decoded)
+    void append(const TransitionLog& other);
+
+    double timestamp(size_t row) const { return _timestamps[row]; }
+
+    int nodeIndex(size_t row) const { return _node_index[row]; }
+
+    NodeStatus prevStatus(size_t row) const { return static_cast<NodeStatus>(_prev_status[row]); }
+
+    NodeStatus status(size_t row) const { return static_cast<NodeStatus>(_status[row]); }
+
+    bool isTreeRestart(size_t row) const { return _is_restart[row] != 0; }
+
+    // row of the last tree restart at or before row (0 if there is none)
+    size_t nearestRestart(size_t row) const;
+
+    // first row with a timestamp not less than the given one
+    size_t lowerBound(double timestamp) const;
+
+    // first row with a timestamp greater than the given one
+    size_t upperBound(double timestamp) const;
+
+    const std::vector<double>& timestamps() const { return _timestamps; }
+
+    const std::vector<int16_t>& nodeIndexes() const { return _node_index; }
+
+    const std::vector<uint32_t>& restartRows() const { return _restart_rows; }
+
+private:
+    friend class TransitionDecoder;
+
+    std::vector<double>   _timestamps;
+    std::vector<int16_t>  _node_index;
+    std::vector<uint8_t>  _prev_status;
+    std::vector<uint8_t>  _status;
+    std::vector<uint8_t>  _is_restart;
+    std::vector<uint32_t> _restart_rows;
+};
+
+// Dense uid -> node index table. The uids written by BT::FileLogger and
+// BT::PublisherZMQ are 16 bits, so a lookup is a single load: no hashing, no bounds check.
+class UidTable
+{
+public:
+    UidTable(): _index( 1 << 16, -1 ) {}
+
+    void insert(uint16_t uid, int index) { _index[uid] = static_cast<int16_t>(index); }
+
+    // -1 if the uid is unknown
+    int indexOf(uint16_t uid) const { return _index[uid]; }
+
+    const int16_t* data() const { return _index.data(); }
+
+private:
+    std::vector<int16_t> _index;
+};
+
+// Turns the packed 12 bytes records of a .fbl file
+// (t_sec, t_usec, uid, prev_status, status) into TransitionLog columns.
+// The decoder keeps the state needed to detect tree restarts, so a log can
+// be decoded in consecutive chunks.
+class TransitionDecoder
+{
+public:
+    static const size_t RECORD_SIZE = 12;
+
+    // size of the (uid, status) records of the status section of a BT::PublisherZMQ message
+    static const size_t STATUS_RECORD_SIZE = 3;
+
+    TransitionDecoder(const UidTable& uid_table, int total_nodes);
+
+    // Decode up to count records and append them to log.
+    // Returns the number of records decoded: decoding stops at the
+    // first record with an unknown uid.
+    size_t decode(const char* records, size_t count, TransitionLog& log);
+
+    // How a tree restart is detected. IDLE_TREE, the default, is the rule of the .fbl logs:
+    // the first child of the root starts while the other nodes are IDLE. ROOT_RUNNING is the
+    // rule of MonitorReceiver: it resets the tree whenever that node goes RUNNING.
+    enum class RestartRule { IDLE_TREE, ROOT_RUNNING };
+
+    void setRestartRule(RestartRule rule) { _restart_rule = rule; }
+
+    // Same for the (uid, status) records of a BT::PublisherZMQ message: the
+    // (node index, status) pairs replace the content of node_status.
+    size_t decodeStatus(const char* records, size_t count,
+                        std::vector<std::pair<int, NodeStatus>>& node_status) const;
+
+private:
+    UidTable _uid_table;
+    int _total_nodes;
+    int _idle_counter;
+    RestartRule _restart_rule;
+};
+
+// Inverted index of a TransitionLog: for each (node, new status) pair,
+// the sorted list of rows where that transition happened.
+class TransitionIndex
+{
+public:
+    TransitionIndex() {}
+
+    void clear() { _rows.clear(); }
+
+    void reset(size_t nodes_count);
+
+    // index the rows [first_row, log.size()). Rows must be appended in order.
+    void append(const TransitionLog& log, size_t first_row);
+
+    const std::vector<uint32_t>& rows(int node_index, NodeStatus status) const
+    {
+        return _rows[ node_index * STATUS_COUNT + static_cast<int>(status) ];
+    }
+
+    struct Query
+    {
+        bool any_node = true;
+        std::vector<int> nodes;
+        bool any_prev_status = true;
+        NodeStatus prev_status = NodeStatus::IDLE;
+        bool any_status = true;
+        NodeStatus status = NodeStatus::IDLE;
+        double min_time = -std::numeric_limits<double>::infinity(); // absolute timestamps
+        double max_time = std::numeric_limits<double>::infinity();
+    };
+
+    // sorted rows in [first_row, last_row) that match the query
+    std::vector<uint32_t> find(const TransitionLog& log, const Query& query,
+                               size_t first_row, size_t last_row) const;
+
+private:
+    static const int STATUS_COUNT = 4;
+    std::vector<std::vector<uint32_t>> _rows;
+};
+
+#endif // TRANSITION_LOG_H
@@ -0,0 +1,103 @@
+#include "transition_stats.h"
+
+#include <algorithm>
+
+void TransitionStats::clear()
+{
+    _nodes.clear();
+}
+
+void TransitionStats::reset(size_t nodes_count)
+{
+    _nodes.clear();
+    _nodes.resize( nodes_count );
+}
+
+void TransitionStats::append(const TransitionLog &log, size_t first_row)
+{
+    for (size_t row = first_row; row < log.size(); row++)
+    {
+        if( log.isTreeRestart(row) )
+        {
+            // the nodes still RUNNING were halted without a transition: drop those periods
+            for (NodeStats& node: _nodes)
+            {
+                node.running_since = -1;
+            }
+        }
+
+        const size_t index = static_cast<size_t>( log.nodeIndex(row) );
+        if( index >= _nodes.size() )
+        {
+            continue;
+        }
+        NodeStats& node = _nodes[index];
+        const NodeStatus prev = log.prevStatus(row);
+        const NodeStatus status = log.status(row);
+        const double timestamp = log.timestamp(row);
+
+        if( prev == NodeStatus::IDLE && status != NodeStatus::IDLE )
+        {
+            node.ticks++;
+        }
+        if( status == NodeStatus::SUCCESS )
+        {
+            node.success++;
+        }
+        else if( status == NodeStatus::FAILURE )
+        {
+            node.failure++;
+        }
+
+        if( status == NodeStatus::RUNNING )
+        {
+            if( node.running_since < 0 )
+            {
+                node.running_since = timestamp;
+            }
+        }
+        else if( node.running_since >= 0 )
+        {
+            const double duration = timestamp - node.running_since;
+            node.running_since = -1;
+
+            if( node.running_durations.empty() )
+            {
+                node.running_min = duration;
+                node.running_max = duration;
+            }
+            else{
+                node.running_min = std::min( node.running_min, duration );
+                node.running_max = std::max( node.running_max, duration );
+            }
+            node.running_total += duration;
+            node.running_durations.push_back( static_cast<float>(duration) );
+        }
+    }
+}
+
+TransitionStats::Summary TransitionStats::summary(size_t node_index) const
+{
+    const NodeStats& node = _nodes.at(node_index);
+
+    Summary summary;
+    summary.ticks = node.ticks;
+    summary.success = node.success;
+    summary.failure = node.failure;
+    summary.running_count = static_cast<int>( node.running_durations.size() );
+
+    if( summary.running_count > 0 )
+    {
+        summary.running_min = node.running_min;
+        summary.running_max = node.running_max;
+        summary.running_total = node.running_total;
+        summary.running_mean = node.running_total / summary.running_count;
+
+        std::vector<float> durations = node.running_durations;
+        const size_t p95 = (durations.size() * 95) / 100;
+        auto nth = durations.begin() + std::min( p95, durations.size() - 1 );
+        std::nth_element( durations.begin(), nth, durations.end() );
+        summary.running_p95 = *nth;
+    }
+    return summary;
+}
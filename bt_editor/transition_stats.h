@@ -0,0 +1,66 @@
+#ifndef TRANSITION_STATS_H
+#define TRANSITION_STATS_H
+
+#include <vector>
+#include <cstddef>
+
+#include "transition_log.h"
+
+// Per-node execution statistics of a TransitionLog.
+// Rows are consumed incrementally, so the statistics can be updated
+// chunk by chunk while a log is being loaded.
+class TransitionStats
+{
+public:
+    struct Summary
+    {
+        int ticks = 0;          // IDLE -> RUNNING, SUCCESS or FAILURE
+        int success = 0;
+        int failure = 0;
+        int running_count = 0;  // completed RUNNING periods
+        double running_min = 0;
+        double running_mean = 0;
+        double running_p95 = 0;
+        double running_max = 0;
+        double running_total = 0;
+
+        // success / (success + failure), -1 if the node never completed
+        double successRatio() const
+        {
+            const int completed = success + failure;
+            return completed > 0 ? double(success) / completed : -1.0;
+        }
+    };
+
+    TransitionStats() {}
+
+    void clear();
+
+    void reset(size_t nodes_count);
+
+    // consume the rows [first_row, log.size()). Rows must be appended in order.
+    void append(const TransitionLog& log, size_t first_row);
+
+    size_t nodesCount() const { return _nodes.size(); }
+
+    // the 95th percentile is computed here, don't call it once per paint
+    Summary summary(size_t node_index) const;
+
+    double runningTotal(size_t node_index) const { return _nodes.at(node_index).running_total; }
+
+private:
+    struct NodeStats
+    {
+        int ticks = 0;
+        int success = 0;
+        int failure = 0;
+        double running_min = 0;
+        double running_max = 0;
+        double running_total = 0;
+        std::vector<float> running_durations;
+        double running_since = -1; // timestamp, -1 if not RUNNING
+    };
+    std::vector<NodeStats> _nodes;
+};
+
+#endif // TRANSITION_STATS_H
@@ -1,5 +1,6 @@
 #include "utils.h"
 #include <set>
+#include <cmath>
 #include <QDebug>
 #include <QDomDocument>
 #include <QMessageBox>
@@ -385,76 +386,6 @@ AbsBehaviorTree BuildTreeFromXML(const QDomElement& bt_root, const NodeModels& m
 }
 
 
-std::pair<AbsBehaviorTree, std::unordered_map<int, int>>
-BuildTreeFromFlatbuffers(const Serialization::BehaviorTree *fb_behavior_tree)
-{
-    AbsBehaviorTree tree;
-    std::unordered_map<int, int> uid_to_index;
-
-    AbstractTreeNode abs_root;
-    abs_root.instance_name = "Root";
-    abs_root.model.registration_ID = "Root";
-    abs_root.model.registration_ID = "Root";
-    abs_root.children_index.push_back( 1 );
-
-    tree.addNode( nullptr, std::move(abs_root) );
-
-    //-----------------------------------------
-    NodeModels models;
-
-    for( const Serialization::NodeModel* model_node: *(fb_behavior_tree->node_models()) )
-    {
-        NodeModel model;
-        model.registration_ID = model_node->registration_name()->c_str();
-        model.type = convert( model_node->type() );
-
-        for( const Serialization::PortModel* port: *(model_node->ports()) )
-        {
-            PortModel port_model;
-            QString port_name = port->port_name()->c_str();
-            port_model.direction = convert( port->direction() );
-            port_model.type_name = port->type_info()->c_str();
-            port_model.description = port->description()->c_str();
-
-            model.ports.insert( { port_name, std::move(port_model) } );
-        }
-
-        models.insert( { model.registration_ID, std::move(model)} );
-    }
-
-    //-----------------------------------------
-    for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
-    {
-        AbstractTreeNode abs_node;
-        abs_node.instance_name = fb_node->instance_name()->c_str();
-        const char* registration_ID = fb_node->registration_name()->c_str();
-        abs_node.status = convert( fb_node->status() );
-        abs_node.model = (models.at(registration_ID));
-
-        for( const Serialization::PortConfig* pair: *(fb_node->port_remaps()) )
-        {
-            abs_node.ports_mapping.insert( { QString(pair->port_name()->c_str()),
-                                             QString(pair->remap()->c_str()) } );
-        }
-        int index = tree.nodesCount();
-        abs_node.index = index;
-        tree.nodes().push_back( std::move(abs_node) );
-        uid_to_index.insert( { fb_node->uid(), index} );
-    }
-
-    for(size_t index = 0; index < fb_behavior_tree->nodes()->size(); index++ )
-    {
-        const Serialization::TreeNode* fb_node = fb_behavior_tree->nodes()->Get(index);
-        AbstractTreeNode* abs_node = tree.node( index + 1);
-        for( const auto child_uid: *(fb_node->children_uid()) )
-        {
-            int child_index = uid_to_index[ child_uid ];
-            abs_node->children_index.push_back(child_index);
-        }
-    }
-    return { tree, uid_to_index };
-}
-
 std::pair<QtNodes::NodeStyle, QtNodes::ConnectionStyle>
 getStyleFromStatus(NodeStatus status, NodeStatus prev_status)
 {
@@ -527,6 +458,57 @@ getStyleFromStatus(NodeStatus status, NodeStatus prev_status)
     return {node_style, conn_style};
 }
 
+void applyHeatToStyle(QtNodes::NodeStyle& node_style, double heat)
+{
+    const QtNodes::NodeStyle default_style;
+    const QColor hot_color(230, 40, 0);
+    heat = std::max( 0.0, std::min( heat, 1.0 ) );
+
+    auto blend = [heat, &hot_color](const QColor& color)
+    {
+        return QColor::fromRgbF( color.redF()   * (1.0 - heat) + hot_color.redF()   * heat,
+                                 color.greenF() * (1.0 - heat) + hot_color.greenF() * heat,
+                                 color.blueF()  * (1.0 - heat) + hot_color.blueF()  * heat );
+    };
+    node_style.GradientColor0 = blend( default_style.GradientColor0 );
+    node_style.GradientColor1 = blend( default_style.GradientColor1 );
+    node_style.GradientColor2 = blend( default_style.GradientColor2 );
+    node_style.GradientColor3 = blend( default_style.GradientColor3 );
+}
+
+const SharedStyle& getSharedStyleFromStatus(NodeStatus status, NodeStatus prev_status, double heat)
+{
+    const int STATUS_COUNT = 4;
+    static std::vector<SharedStyle> table( STATUS_COUNT * STATUS_COUNT * (STATUS_HEAT_LEVELS + 1) );
+
+    const int level = int( std::round( std::max( 0.0, std::min( heat, 1.0 ) ) * STATUS_HEAT_LEVELS ) );
+    SharedStyle& shared = table[ (int(status) * STATUS_COUNT + int(prev_status)) * (STATUS_HEAT_LEVELS + 1) + level ];
+    if( shared.node )
+    {
+        return shared;
+    }
+
+    auto style = getStyleFromStatus( status, prev_status );
+    if( level == 0 )
+    {
+        shared.connection = std::make_shared<const QtNodes::ConnectionStyle>( style.second );
+    }
+    else{
+        // the heat does not change the connection
+        applyHeatToStyle( style.first, double(level) / STATUS_HEAT_LEVELS );
+        shared.connection = getSharedStyleFromStatus( status, prev_status, 0 ).connection;
+    }
+    shared.node = std::make_shared<const QtNodes::NodeStyle>( style.first );
+    return shared;
+}
+
+const SharedStyle& getSharedDefaultStyle()
+{
+    static const SharedStyle shared = { std::make_shared<const QtNodes::NodeStyle>(),
+                                        std::make_shared<const QtNodes::ConnectionStyle>() };
+    return shared;
+}
+
 QtNodes::Node *GetParentNode(QtNodes::Node *node)
 {
     using namespace QtNodes;
@@ -1,14 +1,14 @@
 #ifndef NODE_UTILS_H
 #define NODE_UTILS_H
 
+#include <memory>
 #include <QDomDocument>
 #include <nodes/NodeData>
 #include <nodes/FlowScene>
 #include <nodes/NodeStyle>
 
 #include "bt_editor_base.h"
-#include <behaviortree_cpp_v3/flatbuffers/BT_logger_generated.h>
-#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+#include "fbl_log.h"
 
 QtNodes::Node* findRoot(const QtNodes::FlowScene &scene);
 
@@ -19,9 +19,6 @@ std::vector<QtNodes::Node *> getChildren(const QtNodes::FlowScene &scene,
 AbsBehaviorTree BuildTreeFromScene(const QtNodes::FlowScene *scene,
                                    QtNodes::Node *root_node = nullptr);
 
-std::pair<AbsBehaviorTree, std::unordered_map<int, int> >
-BuildTreeFromFlatbuffers(const Serialization::BehaviorTree* bt );
-
 AbsBehaviorTree BuildTreeFromXML(const QDomElement &bt_root, const NodeModels &models);
 
 void NodeReorder(QtNodes::FlowScene &scene, AbsBehaviorTree &abstract_tree );
@@ -29,6 +26,26 @@ void NodeReorder(QtNodes::FlowScene &scene, AbsBehaviorTree &abstract_tree );
 std::pair<QtNodes::NodeStyle, QtNodes::ConnectionStyle>
 getStyleFromStatus(NodeStatus status, NodeStatus prev_status);
 
+// Tint the body of a node from the default colors (heat <= 0) to red (heat >= 1)
+void applyHeatToStyle(QtNodes::NodeStyle& node_style, double heat);
+
+// Immutable styles shared by all the nodes that look the same:
+// setting them on a node or a connection copies nothing.
+struct SharedStyle
+{
+    std::shared_ptr<const QtNodes::NodeStyle> node;
+    std::shared_ptr<const QtNodes::ConnectionStyle> connection;
+};
+
+const int STATUS_HEAT_LEVELS = 32;
+
+// getStyleFromStatus() and applyHeatToStyle(), with the heat rounded to
+// 1/STATUS_HEAT_LEVELS. Each combination is built once. GUI thread only.
+const SharedStyle& getSharedStyleFromStatus(NodeStatus status, NodeStatus prev_status, double heat = 0);
+
+// the styles of a tree that is not executed
+const SharedStyle& getSharedDefaultStyle();
+
 QtNodes::Node* GetParentNode(QtNodes::Node* node);
 
 std::set<QString> GetModelsToRemove(QWidget* parent,
@@ -2,6 +2,10 @@
 #include "bt_editor/sidepanel_editor.h"
 #include <QAction>
 #include <QLineEdit>
+#include <QGraphicsProxyWidget>
+#include <QStyleOptionGraphicsItem>
+#include <set>
+#include <nodes/LevelOfDetail>
 
 class EditorTest : public GrootTestBase
 {
@@ -14,6 +18,7 @@ public:
 private slots:
     void initTestCase();
     void cleanupTestCase();
+    void cleanup();
     void renameTabs();
     void loadFile();
     void loadFailed();
@@ -27,6 +32,9 @@ private slots:
     void longNames();
     void clearModels();
     void undoWithSubtreeExpanded();
+    void indexedNodes();
+    void paintOnlyNodes();
+    void levelOfDetail();
 };
 
 
@@ -45,6 +53,12 @@ void EditorTest::cleanupTestCase()
     main_win->close();
 }
 
+void EditorTest::cleanup()
+{
+    // even if a check of paintOnlyNodes failed
+    BehaviorTreeDataModel::setPaintOnly( false );
+}
+
 void EditorTest::loadFile()
 {
     QString file_xml = readFile(":/crossdoor_with_subtree.xml");
@@ -633,6 +647,220 @@ void EditorTest::undoWithSubtreeExpanded()
      sleepAndRefresh( 500 );
 }
 
+void EditorTest::indexedNodes()
+{
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( readFile(":/show_all.xml") );
+
+    auto checkIndex = [this]()
+    {
+        // undo may replace the tab
+        auto container = main_win->currentTabInfo();
+        const auto tree = BuildTreeFromScene( container->scene() );
+        const auto& nodes = container->indexedNodes();
+        QCOMPARE( nodes.size(), tree.nodesCount() );
+        for (size_t index = 0; index < nodes.size(); index++)
+        {
+            QCOMPARE( nodes[index].node, tree.node(index)->graphic_node );
+        }
+    };
+    checkIndex();
+
+    // dragging a node changes the order of its siblings
+    auto tree = getAbstractTree();
+    auto pippo_node = tree.findFirstNode("Pippo");
+    auto container = main_win->currentTabInfo();
+    auto view = container->view();
+    const QPoint pippo_screen_pos = view->mapFromScene( pippo_node->pos );
+    QTest::mouseClick( view->viewport(), Qt::LeftButton, Qt::NoModifier, pippo_screen_pos );
+    testDragObject( view, pippo_screen_pos, QPoint(-400, 0) );
+    checkIndex();
+
+    container->deleteSubTreeRecursively( *pippo_node->graphic_node );
+    checkIndex();
+
+    main_win->onUndoInvoked();
+    sleepAndRefresh( 200 );
+    checkIndex();
+}
+
+void EditorTest::paintOnlyNodes()
+{
+    QString file_xml = readFile(":/custom_ports.xml");
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( file_xml );
+    const QString saved_with_widgets = main_win->saveToXML();
+
+    BehaviorTreeDataModel::setPaintOnly( true );
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( file_xml );
+    sleepAndRefresh( 200 );
+
+    // nothing is lost without the widgets
+    QCOMPARE( main_win->saveToXML(), saved_with_widgets );
+
+    auto abs_tree = getAbstractTree();
+    auto action_node = abs_tree.findFirstNode("Action_A");
+    QVERIFY( action_node );
+    auto action_model = dynamic_cast<BehaviorTreeDataModel*>( action_node->graphic_node->nodeDataModel() );
+    QVERIFY( action_model->embeddedWidget() == nullptr );
+    QVERIFY( !action_model->paintedContentSize().isEmpty() );
+
+    // nothing to edit in a locked node: it stays painted
+    main_win->lockEditing( true );
+    action_model->requestEmbeddedWidget();
+    QVERIFY( action_model->embeddedWidget() == nullptr );
+    main_win->lockEditing( false );
+
+    // the editor is created on demand, with the values of the model
+    QtNodes::NodeGeometry& geometry = action_node->graphic_node->nodeGeometry();
+    const QSize painted_size( geometry.width(), geometry.height() );
+    const PortsMapping ports = action_model->getCurrentPortMapping();
+    action_model->requestEmbeddedWidget();
+    QVERIFY( action_model->embeddedWidget() != nullptr );
+
+    // the geometry follows the widget, and the node keeps about the same size
+    const QSize widget_size( geometry.width(), geometry.height() );
+    geometry.recalculateSize();
+    QCOMPARE( QSize( geometry.width(), geometry.height() ), widget_size );
+    QVERIFY2( std::abs( widget_size.width() - painted_size.width() ) <= painted_size.width() / 5 &&
+              std::abs( widget_size.height() - painted_size.height() ) <= painted_size.height() / 5,
+              "The painted node and its widget differ in size" );
+    auto lines = action_model->embeddedWidget()->findChildren<QLineEdit*>();
+    QVERIFY( std::any_of( lines.begin(), lines.end(), [](QLineEdit* line) { return line->text() == "42"; } ) );
+
+    for(auto line: lines)
+    {
+        if( line->text() == "42" )
+        {
+            line->setText( "43" );
+        }
+    }
+    QCOMPARE( action_model->getCurrentPortMapping().at("input"), QString("43") );
+    QCOMPARE( ports.at("input"), QString("42") );
+
+    // the painted expand button works in a locked tree, without hovering first
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( readFile(":/crossdoor_with_subtree.xml") );
+    main_win->lockEditing( true );
+    auto subtree_node = getAbstractTree().findFirstNode("DoorClosed");
+    QVERIFY( subtree_node );
+    auto subtree_model = dynamic_cast<SubtreeNodeModel*>( subtree_node->graphic_node->nodeDataModel() );
+    QVERIFY( subtree_model );
+
+    subtree_model->requestEmbeddedWidget();
+    QVERIFY( subtree_model->expandButton() == nullptr );
+
+    // the button is the last thing drawn, at the bottom of the content
+    const QSize content = subtree_model->paintedContentSize();
+    QSignalSpy expand_spy( subtree_model, &SubtreeNodeModel::expandButtonPushed );
+    QVERIFY( !subtree_model->paintedContentPressed( QPointF( content.width() * 0.5, 1 ) ) );
+    QVERIFY( subtree_model->paintedContentPressed( QPointF( content.width() * 0.5, content.height() - 2 ) ) );
+    QCOMPARE( expand_spy.count(), 1 );
+    QVERIFY( subtree_model->expandButton() != nullptr );
+    QVERIFY( subtree_model->expanded() );
+
+    main_win->lockEditing( false );
+    main_win->on_actionClear_triggered();
+}
+
+void EditorTest::levelOfDetail()
+{
+    using QtNodes::LevelOfDetail;
+
+    QImage image( 100, 100, QImage::Format_ARGB32 );
+    QPainter painter( &image );
+    QCOMPARE( QtNodes::levelOfDetail( &painter ), LevelOfDetail::Full );
+    painter.scale( 0.3, 0.3 );
+    QCOMPARE( QtNodes::levelOfDetail( &painter ), LevelOfDetail::Simplified );
+    painter.scale( 0.5, 0.5 );
+    QCOMPARE( QtNodes::levelOfDetail( &painter ), LevelOfDetail::Minimal );
+    painter.end();
+
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( readFile(":/show_all.xml") );
+    auto view = main_win->currentTabInfo()->view();
+
+    // a node with an editable port
+    QtNodes::Node* graphic_node = nullptr;
+    QLineEdit* line_edit = nullptr;
+    for (const auto& node: getAbstractTree().nodes())
+    {
+        QWidget* widget = node.graphic_node->nodeDataModel()->embeddedWidget();
+        auto lines = widget ? widget->findChildren<QLineEdit*>() : QList<QLineEdit*>();
+        if( !lines.empty() )
+        {
+            graphic_node = node.graphic_node;
+            line_edit = lines.front();
+            break;
+        }
+    }
+    QVERIFY( line_edit );
+    QGraphicsProxyWidget* proxy = graphic_node->nodeDataModel()->embeddedWidget()->graphicsProxyWidget();
+    QVERIFY( proxy );
+
+    // the item painted alone, at the given scale
+    auto render = [](QGraphicsItem* item, double scale)
+    {
+        const QRectF rect = item->boundingRect();
+        QImage item_image( (rect.size() * scale).toSize() + QSize(2, 2), QImage::Format_ARGB32 );
+        item_image.fill( Qt::transparent );
+        QPainter item_painter( &item_image );
+        item_painter.scale( scale, scale );
+        item_painter.translate( -rect.topLeft() );
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = rect;
+        item->paint( &item_painter, &option, nullptr );
+        item_painter.end();
+        return item_image;
+    };
+    auto paintedColors = [](const QImage& image)
+    {
+        std::set<QRgb> colors;
+        for (int y = 0; y < image.height(); y++)
+        {
+            for (int x = 0; x < image.width(); x++)
+            {
+                if( qAlpha( image.pixel(x, y) ) != 0 )
+                {
+                    colors.insert( image.pixel(x, y) );
+                }
+            }
+        }
+        return colors.size();
+    };
+
+    // Minimal: a flat box with its border, not antialiased
+    QVERIFY( paintedColors( render( &graphic_node->nodeGraphicsObject(), 0.1 ) ) <= 2 );
+    // Simplified: the gradient and the caption
+    QVERIFY( paintedColors( render( &graphic_node->nodeGraphicsObject(), 0.3 ) ) > 2 );
+    // the widget is painted only at Full
+    QVERIFY( paintedColors( render( proxy, 1.0 ) ) > 0 );
+    QCOMPARE( paintedColors( render( proxy, 0.3 ) ), size_t(0) );
+    QCOMPARE( paintedColors( render( proxy, 0.1 ) ), size_t(0) );
+
+    // a click on the widget reaches it only when it is painted,
+    // otherwise it selects the node
+    for (double scale: {1.0, 0.3, 0.1})
+    {
+        view->resetTransform();
+        view->scale( scale, scale );
+        view->centerOn( proxy );
+        sleepAndRefresh( 100 );
+        main_win->currentTabInfo()->scene()->clearSelection();
+
+        const QPointF in_proxy = line_edit->mapTo( proxy->widget(), line_edit->rect().center() );
+        const QPoint pos = view->mapFromScene( proxy->mapToScene( in_proxy ) );
+        testMouseEvent(view, QEvent::MouseButtonPress,   pos, Qt::LeftButton);
+        testMouseEvent(view, QEvent::MouseButtonRelease, pos, Qt::LeftButton);
+        sleepAndRefresh( 50 );
+
+        QCOMPARE( graphic_node->nodeGraphicsObject().isSelected(), scale < 0.5 );
+    }
+    view->resetTransform();
+    main_win->on_actionClear_triggered();
+}
+
 QTEST_MAIN(EditorTest)
 
 #include "editor_test.moc"
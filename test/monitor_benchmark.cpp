@@ -0,0 +1,159 @@
+#include "groot_test_base.h"
+#include "bt_editor/sidepanel_monitor.h"
+#include "bt_editor/monitor_load_generator.h"
+#include <QLineEdit>
+#include <QPushButton>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+// Sustained message rate, lags and scene update time of the monitor, fed by a
+// MonitorLoadGenerator on local ports. Not run by ctest: it takes a while and
+// it measures more than it checks.
+//   GROOT_BENCHMARK_SECONDS  measuring time of each case (default: 5)
+//   GROOT_BENCHMARK_OUTPUT   write the results of all the cases to this JSON file
+class MonitorBenchmark : public GrootTestBase
+{
+    Q_OBJECT
+
+public:
+    MonitorBenchmark(): _context(1) {}
+    ~MonitorBenchmark() {}
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void throughput_data();
+    void throughput();
+
+private:
+    // the metrics of the only connection, and of the scene
+    QJsonObject connectionMetrics(SidepanelMonitor* sidepanel_monitor) const;
+
+    zmq::context_t _context;
+    QJsonArray _results;
+};
+
+static const int PUBLISHER_PORT = 11666;
+static const int SERVER_PORT = 11667;
+
+void MonitorBenchmark::initTestCase()
+{
+    main_win = new MainWindow(GraphicMode::MONITOR, nullptr);
+    main_win->resize(1200, 800);
+    main_win->show();
+}
+
+void MonitorBenchmark::cleanupTestCase()
+{
+    const QString output = qgetenv("GROOT_BENCHMARK_OUTPUT");
+    if( !output.isEmpty() )
+    {
+        QFile file(output);
+        QVERIFY2( file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()) );
+        file.write( QJsonDocument( _results ).toJson() );
+    }
+    main_win->on_actionClear_triggered();
+    main_win->close();
+}
+
+QJsonObject MonitorBenchmark::connectionMetrics(SidepanelMonitor *sidepanel_monitor) const
+{
+    const QJsonObject metrics = sidepanel_monitor->metricsToJson();
+    const QJsonArray connections = metrics["connections"].toArray();
+    QJsonObject connection = connections.isEmpty() ? QJsonObject() : connections.first().toObject();
+    connection["scene"] = metrics["scene"];
+    return connection;
+}
+
+void MonitorBenchmark::throughput_data()
+{
+    QTest::addColumn<int>("nodes");
+    QTest::addColumn<double>("rate");
+    QTest::addColumn<int>("transitions");
+
+    QTest::newRow("10 nodes")    << 10    << 500.0  << 10;
+    QTest::newRow("100 nodes")   << 100   << 500.0  << 10;
+    QTest::newRow("1000 nodes")  << 1000  << 500.0  << 10;
+    QTest::newRow("10000 nodes") << 10000 << 500.0  << 10;
+    QTest::newRow("100 nodes, high rate") << 100 << 5000.0 << 10;
+}
+
+void MonitorBenchmark::throughput()
+{
+    QFETCH(int, nodes);
+    QFETCH(double, rate);
+    QFETCH(int, transitions);
+
+    auto sidepanel_monitor = main_win->findChild<SidepanelMonitor*>("SidepanelMonitor");
+    QVERIFY2( sidepanel_monitor, "Can't get pointer to SidepanelMonitor" );
+
+    MonitorLoadGenerator::Options options;
+    options.nodes = nodes;
+    options.messages_rate = rate;
+    options.transitions_per_message = transitions;
+    options.publisher_port = PUBLISHER_PORT;
+    options.server_port = SERVER_PORT;
+
+    MonitorLoadGenerator generator( _context, options );
+    std::string error;
+    QVERIFY2( generator.start( &error ), error.c_str() );
+
+    sidepanel_monitor->findChild<QLineEdit*>("lineEdit")->setText( "localhost" );
+    sidepanel_monitor->findChild<QLineEdit*>("lineEdit_publisher")->setText( QString::number(PUBLISHER_PORT) );
+    sidepanel_monitor->findChild<QLineEdit*>("lineEdit_server")->setText( QString::number(SERVER_PORT) );
+    sidepanel_monitor->findChild<QPushButton*>("pushButtonAddConnection")->click();
+
+    QTRY_VERIFY_WITH_TIMEOUT( connectionMetrics(sidepanel_monitor)["messages"].toDouble() > 0, 30000 );
+
+    // a full metrics window after the tree has been drawn
+    QTest::qWait( 1500 );
+
+    const int seconds = qEnvironmentVariableIsSet("GROOT_BENCHMARK_SECONDS") ?
+                qEnvironmentVariableIntValue("GROOT_BENCHMARK_SECONDS") : 5;
+    const QJsonObject start = connectionMetrics(sidepanel_monitor);
+    const uint64_t start_sent = generator.messagesSent();
+    QElapsedTimer clock;
+    clock.start();
+
+    QTest::qWait( seconds * 1000 );
+
+    const QJsonObject end = connectionMetrics(sidepanel_monitor);
+    const double elapsed = clock.elapsed() * 0.001;
+    const uint64_t sent = generator.messagesSent() - start_sent;
+    sidepanel_monitor->clear();
+    generator.stop();
+
+    const double received = end["messages"].toDouble() - start["messages"].toDouble();
+    const QJsonObject scene = end["scene"].toObject();
+
+    QJsonObject result;
+    result["case"] = QTest::currentDataTag();
+    result["nodes"] = nodes;
+    result["transitions_per_message"] = transitions;
+    result["sent_per_sec"] = sent / elapsed;
+    result["received_per_sec"] = received / elapsed;
+    result["late_messages"] = double( generator.messagesLate() );
+    result["network_lag_sec"] = end["network_lag_sec"];
+    result["apply_lag_sec"] = end["apply_lag_sec"];
+    result["decode_time_sec"] = end["decode_time_sec"];
+    result["scene_update_time_sec"] = scene["update_time_sec"];
+    result["max_scene_update_time_sec"] = scene["max_update_time_sec"];
+    result["scene_updates_per_sec"] = scene["updates_per_sec"];
+    _results.append( result );
+
+    qInfo( "%s: sent %.0f msg/s, received %.0f msg/s, network lag %.2f ms, "
+           "lag when drawn %.2f ms, scene update %.2f ms (max %.2f ms), %.1f frames/s",
+           QTest::currentDataTag(),
+           sent / elapsed, received / elapsed,
+           end["network_lag_sec"].toDouble() * 1e3,
+           end["apply_lag_sec"].toDouble() * 1e3,
+           scene["update_time_sec"].toDouble() * 1e3,
+           scene["max_update_time_sec"].toDouble() * 1e3,
+           scene["updates_per_sec"].toDouble() );
+
+    QVERIFY( received > 0 );
+}
+
+QTEST_MAIN(MonitorBenchmark)
+
+#include "monitor_benchmark.moc"
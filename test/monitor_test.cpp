@@ -0,0 +1,501 @@
+#include "groot_test_base.h"
+#include "bt_editor/sidepanel_monitor.h"
+#include "bt_editor/monitor_load_generator.h"
+#include "bt_editor/monitor_receiver.h"
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLabel>
+#include <QListWidget>
+#include <QJsonArray>
+#include <set>
+
+// The monitor, fed by a MonitorLoadGenerator on local ports
+class MonitorTest : public GrootTestBase
+{
+    Q_OBJECT
+
+public:
+    MonitorTest(): _context(1) {}
+    ~MonitorTest() {}
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void reconnectSameTree();
+    void receiverStatus();
+    void statusCoalescing();
+    void denseUidTable();
+    void downloadCancelAndTimeout();
+    void twoPublishers();
+
+private:
+    SidepanelMonitor* sidepanelMonitor();
+
+    void connectTo(int publisher_port, int server_port);
+
+    // the messages received by a connection, -1 if there is none
+    double receivedMessages(int connection = 0);
+
+    std::set<QUuid> sceneNodes(const QString& tab_name);
+
+    // Wait until the channel receives what publisher sends: the messages sent
+    // before are dropped. Returns the messages counted so far, 0 on timeout.
+    uint64_t subscribe(zmq::socket_t& publisher, MonitorReceiver& receiver, int id);
+
+    zmq::context_t _context;
+};
+
+static const int PUBLISHER_PORT = 11766;
+static const int SERVER_PORT = 11767;
+// a server that never sends the tree
+static const int SILENT_SERVER_PORT = 11768;
+// a second publisher
+static const int PUBLISHER_PORT_2 = 11769;
+static const int SERVER_PORT_2 = 11770;
+
+struct TestTransition{
+    uint16_t uid;
+    NodeStatus prev_status;
+    NodeStatus status;
+};
+
+// A message of BT::PublisherZMQ, written like MonitorLoadGenerator does:
+// | header_size | (uid, status) * N | num_transitions | (12 bytes transition) * M |
+static zmq::message_t PublisherMessage(const std::vector<std::pair<uint16_t, NodeStatus>>& status,
+                                       const std::vector<TestTransition>& transitions)
+{
+    const size_t header_size = status.size() * 3;
+    std::vector<char> buffer( 8 + header_size + transitions.size() * 12 );
+    char* data = buffer.data();
+
+    flatbuffers::WriteScalar<uint32_t>( data, static_cast<uint32_t>(header_size) );
+    data += 4;
+    for (const auto& it: status)
+    {
+        flatbuffers::WriteScalar<uint16_t>( data, it.first );
+        flatbuffers::WriteScalar<int8_t>( data + 2, static_cast<int8_t>( BT::convertToFlatbuffers(it.second) ) );
+        data += 3;
+    }
+    flatbuffers::WriteScalar<uint32_t>( data, static_cast<uint32_t>(transitions.size()) );
+    data += 4;
+
+    static int seconds = 1000;
+    for (const auto& transition: transitions)
+    {
+        const auto record = BT::SerializeTransition( transition.uid, std::chrono::seconds( seconds++ ),
+                                                     transition.prev_status, transition.status );
+        std::copy( record.begin(), record.end(), data );
+        data += 12;
+    }
+    return zmq::message_t( buffer.data(), buffer.size() );
+}
+
+void MonitorTest::initTestCase()
+{
+    main_win = new MainWindow(GraphicMode::MONITOR, nullptr);
+    main_win->resize(1200, 800);
+    main_win->show();
+}
+
+void MonitorTest::cleanupTestCase()
+{
+    main_win->on_actionClear_triggered();
+    main_win->close();
+}
+
+SidepanelMonitor *MonitorTest::sidepanelMonitor()
+{
+    return main_win->findChild<SidepanelMonitor*>("SidepanelMonitor");
+}
+
+void MonitorTest::connectTo(int publisher_port, int server_port)
+{
+    auto sidepanel_monitor = sidepanelMonitor();
+    sidepanel_monitor->findChild<QLineEdit*>("lineEdit")->setText( "localhost" );
+    sidepanel_monitor->findChild<QLineEdit*>("lineEdit_publisher")->setText( QString::number(publisher_port) );
+    sidepanel_monitor->findChild<QLineEdit*>("lineEdit_server")->setText( QString::number(server_port) );
+    sidepanel_monitor->findChild<QPushButton*>("pushButtonAddConnection")->click();
+}
+
+double MonitorTest::receivedMessages(int connection)
+{
+    const QJsonArray connections = sidepanelMonitor()->metricsToJson()["connections"].toArray();
+    if( connection >= connections.size() || !connections[connection].toObject()["connected"].toBool() )
+    {
+        return -1;
+    }
+    return connections[connection].toObject()["messages"].toDouble();
+}
+
+std::set<QUuid> MonitorTest::sceneNodes(const QString &tab_name)
+{
+    std::set<QUuid> ids;
+    auto container = main_win->getTabByName( tab_name );
+    if( container )
+    {
+        for (const auto& it: container->scene()->nodes())
+        {
+            ids.insert( it.first );
+        }
+    }
+    return ids;
+}
+
+uint64_t MonitorTest::subscribe(zmq::socket_t &publisher, MonitorReceiver &receiver, int id)
+{
+    // a message too short to be decoded is counted, and changes nothing
+    MonitorReceiver::Snapshot snapshot;
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        zmq::message_t empty(4);
+        publisher.send( empty );
+        QTest::qWait( 50 );
+        if( receiver.peekSnapshot( id, &snapshot ) && snapshot.counters.messages > 0 )
+        {
+            return snapshot.counters.messages;
+        }
+    }
+    return 0;
+}
+
+void MonitorTest::reconnectSameTree()
+{
+    auto sidepanel_monitor = sidepanelMonitor();
+    QVERIFY2( sidepanel_monitor, "Can't get pointer to SidepanelMonitor" );
+
+    MonitorLoadGenerator::Options options;
+    options.nodes = 50;
+    options.messages_rate = 200;
+    options.publisher_port = PUBLISHER_PORT;
+    options.server_port = SERVER_PORT;
+
+    MonitorLoadGenerator generator( _context, options );
+    std::string error;
+    QVERIFY2( generator.start( &error ), error.c_str() );
+
+    connectTo( PUBLISHER_PORT, SERVER_PORT );
+    QTRY_VERIFY_WITH_TIMEOUT( receivedMessages() > 0, 10000 );
+    const std::set<QUuid> first_nodes = sceneNodes( "BehaviorTree" );
+    QVERIFY( !first_nodes.empty() );
+
+    // a new connection: the status of the nodes differs, the tree does not
+    sidepanel_monitor->clear();
+    QCOMPARE( receivedMessages(), -1.0 );
+    connectTo( PUBLISHER_PORT, SERVER_PORT );
+    QTRY_VERIFY_WITH_TIMEOUT( receivedMessages() > 0, 10000 );
+
+    QCOMPARE( generator.treeRequests(), uint64_t(2) );
+    QVERIFY2( sceneNodes( "BehaviorTree" ) == first_nodes, "The scene has been rebuilt" );
+
+    // unless the scene has been changed in the meantime
+    sidepanel_monitor->clear();
+    main_win->on_actionClear_triggered();
+    connectTo( PUBLISHER_PORT, SERVER_PORT );
+    QTRY_VERIFY_WITH_TIMEOUT( receivedMessages() > 0, 10000 );
+    QCOMPARE( sceneNodes( "BehaviorTree" ).size(), first_nodes.size() );
+    QVERIFY( sceneNodes( "BehaviorTree" ) != first_nodes );
+
+    sidepanel_monitor->clear();
+    generator.stop();
+}
+
+void MonitorTest::receiverStatus()
+{
+    using NodeState = MonitorReceiver::NodeState;
+    const NodeStatus IDLE = NodeStatus::IDLE;
+    const NodeStatus RUNNING = NodeStatus::RUNNING;
+    const NodeStatus SUCCESS = NodeStatus::SUCCESS;
+
+    // four nodes, with uids 10 to 13; the node 1 is the first child of the root
+    UidTable uid_to_index;
+    for (int index = 0; index < 4; index++)
+    {
+        uid_to_index.insert( uint16_t(10 + index), index );
+    }
+
+    const char* address = "inproc://monitor_test_receiver";
+    zmq::socket_t publisher( _context, ZMQ_PUB );
+    publisher.bind( address );
+
+    MonitorReceiver receiver( _context );
+    receiver.addChannel( 1, address, uid_to_index, {IDLE, IDLE, IDLE, IDLE}, nullptr, 1024 );
+
+    MonitorReceiver::Snapshot snapshot;
+    auto received = [&](uint64_t messages)
+    {
+        return receiver.takeSnapshot( 1, &snapshot, true ) && snapshot.counters.messages >= messages;
+    };
+
+    const uint64_t first = subscribe( publisher, receiver, 1 );
+    QVERIFY( first > 0 );
+
+    auto message = PublisherMessage( {{10, IDLE}, {11, RUNNING}, {12, SUCCESS}, {13, IDLE}},
+                                     {{11, IDLE, RUNNING}, {12, IDLE, RUNNING}, {12, RUNNING, SUCCESS}} );
+    publisher.send( message );
+    QTRY_VERIFY_WITH_TIMEOUT( received( first + 1 ), 5000 );
+    QVERIFY( snapshot.nodes == std::vector<NodeState>( { {IDLE, IDLE}, {RUNNING, IDLE},
+                                                         {SUCCESS, RUNNING}, {IDLE, IDLE} } ) );
+    QCOMPARE( snapshot.counters.transitions, uint64_t(3) );
+    QCOMPARE( snapshot.counters.resyncs, uint64_t(0) );
+
+    // a new tick: the tree is reset when the node 1 goes RUNNING again
+    message = PublisherMessage( {{10, IDLE}, {11, RUNNING}, {12, IDLE}, {13, RUNNING}},
+                                {{11, RUNNING, SUCCESS}, {11, SUCCESS, IDLE}, {11, IDLE, RUNNING}, {13, IDLE, RUNNING}} );
+    publisher.send( message );
+    QTRY_VERIFY_WITH_TIMEOUT( received( first + 2 ), 5000 );
+    QVERIFY( snapshot.nodes == std::vector<NodeState>( { {IDLE, IDLE}, {RUNNING, IDLE},
+                                                         {IDLE, IDLE}, {RUNNING, IDLE} } ) );
+    QCOMPARE( snapshot.counters.resyncs, uint64_t(0) );
+
+    // the message with the transitions of the node 3 was dropped: the status section fixes it
+    message = PublisherMessage( {{10, IDLE}, {11, RUNNING}, {12, IDLE}, {13, SUCCESS}}, {} );
+    publisher.send( message );
+    QTRY_VERIFY_WITH_TIMEOUT( received( first + 3 ), 5000 );
+    const std::vector<NodeState> last_state = { {IDLE, IDLE}, {RUNNING, IDLE},
+                                                {IDLE, IDLE}, {SUCCESS, RUNNING} };
+    QVERIFY( snapshot.nodes == last_state );
+    QCOMPARE( snapshot.counters.resyncs, uint64_t(1) );
+
+    // the history replayed like the rewind does ends in the same state
+    const std::vector<char> history = receiver.copyHistory( 1 );
+    QCOMPARE( history.size(), size_t(8 * TransitionDecoder::RECORD_SIZE) );
+    TransitionLog log;
+    TransitionDecoder decoder( uid_to_index, 4 );
+    decoder.setRestartRule( TransitionDecoder::RestartRule::ROOT_RUNNING );
+    QCOMPARE( decoder.decode( history.data(), 8, log ), size_t(8) );
+    TransitionCheckpoints checkpoints;
+    checkpoints.reset( 4 );
+    checkpoints.append( log, 0 );
+    QVERIFY( checkpoints.stateAtRow( log, log.size() - 1 ) == last_state );
+
+    receiver.removeChannel( 1 );
+}
+
+void MonitorTest::statusCoalescing()
+{
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( readFile(":/crossdoor_with_subtree.xml") );
+    const QString tab_name = main_win->currentTabName();
+    const auto& nodes = main_win->currentTabInfo()->indexedNodes();
+    QVERIFY( nodes.size() > 4 );
+
+    auto nodeStyle = [&](int index)
+    {
+        return &nodes[index].node->nodeDataModel()->nodeStyle();
+    };
+    auto statusStyle = [](NodeStatus status, NodeStatus prev_status)
+    {
+        return getSharedStyleFromStatus( status, prev_status ).node.get();
+    };
+
+    // a burst of updates: the last status of each node is applied, once, in the next frame
+    const auto stats = main_win->statusUpdateStats();
+    for (int i = 0; i < 100; i++)
+    {
+        const NodeStatus result = (i % 2 == 0) ? NodeStatus::FAILURE : NodeStatus::SUCCESS;
+        main_win->onChangeNodesStatus( tab_name, { {2, NodeStatus::RUNNING}, {2, result},
+                                                   {3, NodeStatus::RUNNING} }, false );
+    }
+    QCOMPARE( main_win->statusUpdateStats().frames, stats.frames );
+    QTRY_COMPARE( main_win->statusUpdateStats().frames, stats.frames + 1 );
+    QCOMPARE( main_win->statusUpdateStats().nodes, stats.nodes + 2 );
+    QVERIFY( nodeStyle(2) == statusStyle( NodeStatus::SUCCESS, NodeStatus::RUNNING ) );
+    QVERIFY( nodeStyle(3) == statusStyle( NodeStatus::RUNNING, NodeStatus::IDLE ) );
+
+    // a new tick of the root drops what was pending before it, and resets the others
+    main_win->onChangeNodesStatus( tab_name, { {4, NodeStatus::FAILURE} }, true );
+    main_win->onChangeNodesStatus( tab_name, { {1, NodeStatus::RUNNING} }, true );
+    QTRY_COMPARE( main_win->statusUpdateStats().frames, stats.frames + 2 );
+    QCOMPARE( main_win->statusUpdateStats().nodes, stats.nodes + 3 );
+    QVERIFY( nodeStyle(1) == statusStyle( NodeStatus::RUNNING, NodeStatus::IDLE ) );
+    for (int index: {2, 3, 4})
+    {
+        QVERIFY( nodeStyle(index) == getSharedDefaultStyle().node.get() );
+    }
+    main_win->on_actionClear_triggered();
+}
+
+void MonitorTest::denseUidTable()
+{
+    using NodeState = MonitorReceiver::NodeState;
+    const NodeStatus IDLE = NodeStatus::IDLE;
+    const NodeStatus RUNNING = NodeStatus::RUNNING;
+
+    // the lowest and the highest 16 bits uids
+    UidTable uid_to_index;
+    uid_to_index.insert( 0, 1 );
+    uid_to_index.insert( 300, 2 );
+    uid_to_index.insert( 65535, 3 );
+    QCOMPARE( uid_to_index.indexOf( 0 ), 1 );
+    QCOMPARE( uid_to_index.indexOf( 300 ), 2 );
+    QCOMPARE( uid_to_index.indexOf( 65535 ), 3 );
+    QCOMPARE( uid_to_index.indexOf( 1 ), -1 );
+    QCOMPARE( uid_to_index.indexOf( 65534 ), -1 );
+
+    // the decoders stop at the first unknown uid
+    auto record = [](uint16_t uid)
+    {
+        const auto transition = BT::SerializeTransition( uid, std::chrono::seconds(1),
+                                                         NodeStatus::IDLE, NodeStatus::RUNNING );
+        return std::vector<char>( transition.begin(), transition.end() );
+    };
+    std::vector<char> records;
+    for (uint16_t uid: {65535, 0, 300, 65534, 300})
+    {
+        const auto data = record( uid );
+        records.insert( records.end(), data.begin(), data.end() );
+    }
+    TransitionDecoder decoder( uid_to_index, 4 );
+    TransitionLog log;
+    QCOMPARE( decoder.decode( records.data(), 5, log ), size_t(3) );
+    QCOMPARE( log.size(), size_t(3) );
+    QCOMPARE( log.nodeIndex(0), 3 );
+    QCOMPARE( log.nodeIndex(1), 1 );
+    QCOMPARE( log.nodeIndex(2), 2 );
+
+    const char status_records[] = { '\xff', '\xff', 1, 0, 0, 1, '\xfe', '\xff', 1 };
+    std::vector<std::pair<int, NodeStatus>> node_status;
+    QCOMPARE( decoder.decodeStatus( status_records, 3, node_status ), size_t(2) );
+    QCOMPARE( node_status.size(), size_t(2) );
+    QCOMPARE( node_status[0].first, 3 );
+    QCOMPARE( node_status[1].first, 1 );
+
+    // the same table in the receiver
+    const char* address = "inproc://monitor_test_uids";
+    zmq::socket_t publisher( _context, ZMQ_PUB );
+    publisher.bind( address );
+    MonitorReceiver receiver( _context );
+    receiver.addChannel( 1, address, uid_to_index, {IDLE, IDLE, IDLE, IDLE}, nullptr, 1024 );
+    const uint64_t first = subscribe( publisher, receiver, 1 );
+    QVERIFY( first > 0 );
+
+    MonitorReceiver::Snapshot snapshot;
+    auto message = PublisherMessage( {{0, IDLE}, {300, IDLE}, {65535, RUNNING}}, {{65535, IDLE, RUNNING}} );
+    publisher.send( message );
+    QTRY_VERIFY_WITH_TIMEOUT( receiver.takeSnapshot( 1, &snapshot, true ) &&
+                              snapshot.counters.messages == first + 1, 5000 );
+    QVERIFY( !snapshot.unknown_uid );
+    QVERIFY( snapshot.nodes[3] == (NodeState{RUNNING, IDLE}) );
+
+    // a uid of another tree
+    message = PublisherMessage( {{0, IDLE}, {300, IDLE}, {65535, RUNNING}}, {{65534, IDLE, RUNNING}} );
+    publisher.send( message );
+    QTRY_VERIFY_WITH_TIMEOUT( receiver.takeSnapshot( 1, &snapshot, true ) &&
+                              snapshot.counters.messages == first + 2, 5000 );
+    QVERIFY( snapshot.unknown_uid );
+
+    receiver.removeChannel( 1 );
+}
+
+void MonitorTest::downloadCancelAndTimeout()
+{
+    auto sidepanel_monitor = sidepanelMonitor();
+    auto cancel_button = sidepanel_monitor->findChild<QPushButton*>("pushButtonCancelDownload");
+    auto progress_bar = sidepanel_monitor->findChild<QProgressBar*>("progressBarDownload");
+    auto label = sidepanel_monitor->findChild<QLabel*>("labelCount");
+    QVERIFY( cancel_button && progress_bar && label );
+
+    auto connectionsCount = [&]()
+    {
+        return sidepanel_monitor->metricsToJson()["connections"].toArray().size();
+    };
+
+    zmq::socket_t server( _context, ZMQ_REP );
+    int linger_ms = 0;
+    server.setsockopt( ZMQ_LINGER, &linger_ms, sizeof(int) );
+    server.bind( ("tcp://*:" + std::to_string(SILENT_SERVER_PORT)).c_str() );
+
+    // the GUI thread does not wait for the tree
+    QElapsedTimer clock;
+    clock.start();
+    connectTo( PUBLISHER_PORT, SILENT_SERVER_PORT );
+    QVERIFY( clock.elapsed() < 1000 );
+    QCOMPARE( connectionsCount(), 1 );
+    QVERIFY( !cancel_button->isHidden() );
+    QTRY_VERIFY( progress_bar->value() > 0 );
+
+    // cancelled: the worker notices it within one poll
+    clock.restart();
+    cancel_button->click();
+    QVERIFY( clock.elapsed() < 1000 );
+    QCOMPARE( connectionsCount(), 0 );
+    QCOMPARE( label->text(), QString("Connection cancelled") );
+    QTRY_VERIFY( cancel_button->isHidden() );
+
+    // dropped after the timeout, with a warning
+    connectTo( PUBLISHER_PORT, SILENT_SERVER_PORT );
+    QCOMPARE( connectionsCount(), 1 );
+    testMessageBox( SidepanelMonitor::DOWNLOAD_TIMEOUT_MS + 1000, TEST_LOCATION(), [&]()
+    {
+        QTest::qWait( SidepanelMonitor::DOWNLOAD_TIMEOUT_MS + 2000 );
+    });
+    QCOMPARE( connectionsCount(), 0 );
+    QVERIFY( label->text().startsWith("Disconnected from") );
+    QTRY_VERIFY( cancel_button->isHidden() );
+}
+
+void MonitorTest::twoPublishers()
+{
+    auto sidepanel_monitor = sidepanelMonitor();
+    QVERIFY2( sidepanel_monitor, "Can't get pointer to SidepanelMonitor" );
+    main_win->on_actionClear_triggered();
+
+    // two trees of different sizes
+    MonitorLoadGenerator::Options options;
+    options.nodes = 30;
+    options.messages_rate = 200;
+    options.publisher_port = PUBLISHER_PORT;
+    options.server_port = SERVER_PORT;
+    MonitorLoadGenerator first( _context, options );
+
+    options.nodes = 60;
+    options.seed = 1;
+    options.publisher_port = PUBLISHER_PORT_2;
+    options.server_port = SERVER_PORT_2;
+    MonitorLoadGenerator second( _context, options );
+
+    std::string error;
+    QVERIFY2( first.start( &error ), error.c_str() );
+    QVERIFY2( second.start( &error ), error.c_str() );
+
+    connectTo( PUBLISHER_PORT, SERVER_PORT );
+    connectTo( PUBLISHER_PORT_2, SERVER_PORT_2 );
+    QTRY_VERIFY_WITH_TIMEOUT( receivedMessages(0) > 0 && receivedMessages(1) > 0, 10000 );
+
+    // each one in its own tab, the first one in the default tab
+    const QJsonArray connections = sidepanel_monitor->metricsToJson()["connections"].toArray();
+    QCOMPARE( connections.size(), 2 );
+    const QString first_tab = connections[0].toObject()["tab"].toString();
+    const QString second_tab = connections[1].toObject()["tab"].toString();
+    QCOMPARE( first_tab, QString("BehaviorTree") );
+    QCOMPARE( second_tab, QString("localhost:%1").arg(PUBLISHER_PORT_2) );
+    const size_t first_nodes = sceneNodes( first_tab ).size();
+    const size_t second_nodes = sceneNodes( second_tab ).size();
+    QVERIFY( first_nodes > 0 );
+    QCOMPARE( second_nodes - first_nodes, size_t(30) );
+    QCOMPARE( first.treeRequests(), uint64_t(1) );
+    QCOMPARE( second.treeRequests(), uint64_t(1) );
+
+    // the second one keeps receiving once the first one is removed
+    auto list = sidepanel_monitor->findChild<QListWidget*>("listConnections");
+    QVERIFY( list && list->count() == 2 );
+    list->setCurrentRow( 0 );
+    sidepanel_monitor->findChild<QPushButton*>("pushButtonRemoveConnection")->click();
+    QCOMPARE( sidepanel_monitor->metricsToJson()["connections"].toArray().size(), 1 );
+    const double received = receivedMessages(0);
+    QCOMPARE( sidepanel_monitor->metricsToJson()["connections"].toArray()[0].toObject()["tab"].toString(),
+              second_tab );
+    QTRY_VERIFY_WITH_TIMEOUT( receivedMessages(0) > received, 5000 );
+    QCOMPARE( sceneNodes( second_tab ).size(), second_nodes );
+
+    sidepanel_monitor->clear();
+    first.stop();
+    second.stop();
+    main_win->on_actionClear_triggered();
+}
+
+QTEST_MAIN(MonitorTest)
+
+#include "monitor_test.moc"
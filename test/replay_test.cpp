@@ -1,6 +1,18 @@
 #include "groot_test_base.h"
 #include "bt_editor/sidepanel_replay.h"
+#include "bt_editor/fbl_writer.h"
+#include "bt_editor/transition_history.h"
+#include "bt_editor/fbl_report.h"
 #include <QAction>
+#include <QTableView>
+#include <QLineEdit>
+#include <QTabWidget>
+#include <QCheckBox>
+#include <QTemporaryFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <cmath>
+#include <map>
 
 class ReplyTest : public GrootTestBase
 {
@@ -14,8 +26,113 @@ private slots:
     void initTestCase();
     void cleanupTestCase();
     void basicLoad();
+    void filterTransitions();
+    void statistics();
+    void followGrowingFile();
+    void writeLog();
+    void transitionRing();
+    void analyzeLog();
+    void analyzeLogErrors();
+    void transitionIndex();
+    void checkpointSeek();
+    void playbackClock();
+    void sparseTree();
+
+private:
+    // write log to a temporary file and analyze it
+    LogReport analyzeData(const QByteArray& log);
 };
 
+// The header of a log of a Sequence "Seq" (uid 1) with the actions "A" (uid 2)
+// and "B" (uid 3). The uids of the children of Seq can be changed to break the tree.
+// When sparse, the empty vectors (ports, remaps, children of the leaves) are left out.
+static QByteArray TestLogHeader(const std::vector<uint16_t>& seq_children = {2, 3},
+                                bool sparse = false)
+{
+    flatbuffers::FlatBufferBuilder builder(1024);
+
+    auto model = [&builder, sparse](const char* name, Serialization::NodeType type)
+    {
+        flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Serialization::PortModel>>> ports;
+        if( !sparse )
+        {
+            ports = builder.CreateVector( std::vector<flatbuffers::Offset<Serialization::PortModel>>() );
+        }
+        return Serialization::CreateNodeModel( builder, builder.CreateString(name), type, ports );
+    };
+    auto node = [&builder, sparse](uint16_t uid, const std::vector<uint16_t>& children,
+                                   const char* name, const char* registration_name)
+    {
+        flatbuffers::Offset<flatbuffers::Vector<uint16_t>> children_uid;
+        flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Serialization::PortConfig>>> remaps;
+        if( !sparse || !children.empty() )
+        {
+            children_uid = builder.CreateVector(children);
+        }
+        if( !sparse )
+        {
+            remaps = builder.CreateVector( std::vector<flatbuffers::Offset<Serialization::PortConfig>>() );
+        }
+        return Serialization::CreateTreeNode(
+                    builder, uid, children_uid, Serialization::NodeStatus::IDLE,
+                    builder.CreateString(name), builder.CreateString(registration_name), remaps );
+    };
+
+    std::vector<flatbuffers::Offset<Serialization::NodeModel>> models;
+    models.push_back( model("Sequence", Serialization::NodeType::CONTROL) );
+    models.push_back( model("Action", Serialization::NodeType::ACTION) );
+
+    std::vector<flatbuffers::Offset<Serialization::TreeNode>> nodes;
+    nodes.push_back( node(1, seq_children, "Seq", "Sequence") );
+    nodes.push_back( node(2, {}, "A", "Action") );
+    nodes.push_back( node(3, {}, "B", "Action") );
+
+    auto tree = Serialization::CreateBehaviorTree( builder, 1, builder.CreateVector(nodes),
+                                                   builder.CreateVector(models) );
+    builder.Finish( tree );
+
+    QByteArray log( 4, 0 );
+    flatbuffers::WriteScalar<uint32_t>( log.data(), builder.GetSize() );
+    log.append( reinterpret_cast<const char*>( builder.GetBufferPointer() ), int(builder.GetSize()) );
+    return log;
+}
+
+// a 12 bytes record, as written by BT::FileLogger
+static void AppendTransition(QByteArray& log, double time, uint16_t uid,
+                             Serialization::NodeStatus prev_status, Serialization::NodeStatus status)
+{
+    char record[12];
+    const uint32_t t_sec = uint32_t(time);
+    flatbuffers::WriteScalar<uint32_t>( record, t_sec );
+    flatbuffers::WriteScalar<uint32_t>( record + 4, uint32_t( std::round( (time - t_sec) * 1e6 ) ) );
+    flatbuffers::WriteScalar<uint16_t>( record + 8, uid );
+    record[10] = static_cast<char>( prev_status );
+    record[11] = static_cast<char>( status );
+    log.append( record, 12 );
+}
+
+// Two ticks of TestLogHeader(): B fails in the first one, A in the second one.
+static QByteArray TestLog(const QByteArray& header = TestLogHeader())
+{
+    using Serialization::NodeStatus;
+    QByteArray log = header;
+    AppendTransition( log, 1.0, 1, NodeStatus::IDLE,    NodeStatus::RUNNING );
+    AppendTransition( log, 1.1, 2, NodeStatus::IDLE,    NodeStatus::RUNNING );
+    AppendTransition( log, 1.2, 2, NodeStatus::RUNNING, NodeStatus::SUCCESS );
+    AppendTransition( log, 1.3, 3, NodeStatus::IDLE,    NodeStatus::RUNNING );
+    AppendTransition( log, 1.4, 3, NodeStatus::RUNNING, NodeStatus::FAILURE );
+    AppendTransition( log, 1.5, 1, NodeStatus::RUNNING, NodeStatus::FAILURE );
+    AppendTransition( log, 1.6, 2, NodeStatus::SUCCESS, NodeStatus::IDLE );
+    AppendTransition( log, 1.6, 3, NodeStatus::FAILURE, NodeStatus::IDLE );
+    AppendTransition( log, 1.6, 1, NodeStatus::FAILURE, NodeStatus::IDLE );
+
+    AppendTransition( log, 2.0, 1, NodeStatus::IDLE,    NodeStatus::RUNNING );
+    AppendTransition( log, 2.1, 2, NodeStatus::IDLE,    NodeStatus::RUNNING );
+    AppendTransition( log, 2.5, 2, NodeStatus::RUNNING, NodeStatus::FAILURE );
+    AppendTransition( log, 2.6, 1, NodeStatus::RUNNING, NodeStatus::FAILURE );
+    return log;
+}
+
 
 void ReplyTest::initTestCase()
 {
@@ -40,7 +157,494 @@ void ReplyTest::basicLoad()
     QByteArray log = readFile("://crossdoor_trace.fbl");
     sidepanel_replay->loadLog( log );
 
+    // transitions are parsed in a background thread
+    QTRY_VERIFY( !sidepanel_replay->isLoading() );
+    QCOMPARE( sidepanel_replay->transitionsCount(), size_t(27) );
+
+    auto table_view = sidepanel_replay->findChild<QTableView*>("tableView");
+    QVERIFY2( table_view, "Can't get pointer to the transitions table" );
+    QCOMPARE( table_view->model()->rowCount(), 27 );
+    QCOMPARE( table_view->model()->data( table_view->model()->index(0,0) ).toString(),
+              QString("0.000") );
+
+    // a file with a corrupt header is rejected, after a warning
+    QTemporaryFile file;
+    QVERIFY( file.open() );
+    file.write( log.left(20) );
+    file.flush();
+    bool loaded = true;
+    testMessageBox(500, TEST_LOCATION(), [&]()
+    {
+        loaded = sidepanel_replay->loadLogFile( file.fileName() );
+    });
+    QVERIFY( !loaded );
+}
+
+void ReplyTest::filterTransitions()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    sidepanel_replay->loadLog( log );
+    QTRY_VERIFY( !sidepanel_replay->isLoading() );
+
+    auto table_view = sidepanel_replay->findChild<QTableView*>("tableView");
+    auto line_edit  = sidepanel_replay->findChild<QLineEdit*>("lineEditFilter");
+    QVERIFY2( table_view && line_edit, "Can't get pointer to the filter widgets" );
+
+    line_edit->setText("->FAILURE");
+    QCOMPARE( table_view->model()->rowCount(), 3 );
+
+    line_edit->setText("running->failure");
+    QCOMPARE( table_view->model()->rowCount(), 1 );
+    QCOMPARE( table_view->model()->data( table_view->model()->index(0,3) ).toString(),
+              QString("FAILURE") );
+
+    line_edit->setText("->FAILURE t:..1");
+    QCOMPARE( table_view->model()->rowCount(), 2 );
+
+    line_edit->clear();
+    QCOMPARE( table_view->model()->rowCount(), 27 );
+}
+
+void ReplyTest::statistics()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    sidepanel_replay->loadLog( log );
+    QTRY_VERIFY( !sidepanel_replay->isLoading() );
+
+    auto tab_widget = sidepanel_replay->findChild<QTabWidget*>("tabWidgetReplay");
+    auto stats_view = sidepanel_replay->findChild<QTableView*>("tableViewStats");
+    QVERIFY2( tab_widget && stats_view, "Can't get pointer to the statistics widgets" );
+    tab_widget->setCurrentWidget( stats_view->parentWidget() );
+
+    // sorted by total RUNNING time: the root runs for the whole log
+    auto model = stats_view->model();
+    QVERIFY( model->rowCount() > 0 );
+    QCOMPARE( model->data( model->index(0,1) ).toInt(), 1 );     // ticks
+    QCOMPARE( model->data( model->index(0,2) ).toString(), QString("100.0%") );
+    QCOMPARE( model->data( model->index(0,7) ).toString(), QString("4.002") );
+
+    tab_widget->setCurrentIndex(0);
+}
+
+void ReplyTest::followGrowingFile()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    const int header_size = 4 + flatbuffers::ReadScalar<uint32_t>( log.constData() );
+
+    // the header and the first 10 transitions, then half of the 11th
+    QTemporaryFile file;
+    QVERIFY( file.open() );
+    file.write( log.left( header_size + 10*12 + 6 ) );
+    file.flush();
+
+    QVERIFY( sidepanel_replay->loadLogFile( file.fileName() ) );
+    QTRY_VERIFY( !sidepanel_replay->isLoading() );
+    QCOMPARE( sidepanel_replay->transitionsCount(), size_t(10) );
+
+    auto follow = sidepanel_replay->findChild<QCheckBox*>("checkBoxFollow");
+    QVERIFY2( follow, "Can't get pointer to the follow checkbox" );
+    QVERIFY( follow->isEnabled() );
+    follow->setChecked(true);
+
+    file.write( log.mid( header_size + 10*12 + 6 ) );
+    file.flush();
+    QTRY_COMPARE( sidepanel_replay->transitionsCount(), size_t(27) );
+
+    follow->setChecked(false);
+    sidepanel_replay->clear();
+}
+
+void ReplyTest::writeLog()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    const int header_size = 4 + flatbuffers::ReadScalar<uint32_t>( log.constData() );
+    const QByteArray records = log.mid( header_size );
+
+    QTemporaryFile file;
+    QVERIFY( file.open() );
+
+    // the records arrive in small pieces, like the monitor messages
+    FblWriter writer;
+    QString error;
+    QVERIFY2( writer.open( file.fileName(), log.mid(4, header_size - 4), &error ), error.toStdString().c_str() );
+    for (int offset = 0; offset < records.size(); offset += 3*12)
+    {
+        const QByteArray piece = records.mid( offset, 3*12 );
+        writer.append( piece.constData(), size_t(piece.size()) );
+    }
+    QCOMPARE( writer.size(), uint64_t(log.size()) );
+    writer.close();
+
+    QCOMPARE( readFile( file.fileName().toStdString().c_str() ), log );
+
+    QVERIFY( sidepanel_replay->loadLogFile( file.fileName() ) );
+    QTRY_VERIFY( !sidepanel_replay->isLoading() );
     QCOMPARE( sidepanel_replay->transitionsCount(), size_t(27) );
+    sidepanel_replay->clear();
+}
+
+void ReplyTest::transitionRing()
+{
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    const int header_size = 4 + flatbuffers::ReadScalar<uint32_t>( log.constData() );
+    const QByteArray records = log.mid( header_size );
+    const int RECORD_SIZE = int(TransitionDecoder::RECORD_SIZE);
+
+    TransitionRing ring( 10 );
+    QVERIFY( ring.copy().empty() );
+
+    // pieces smaller and larger than the ring, wrapping around its end
+    const int pieces[] = { 3, 4, 1, 12, 2, 5 };
+    int offset = 0;
+    for (int piece: pieces)
+    {
+        ring.push( records.constData() + offset * RECORD_SIZE, size_t(piece) );
+        offset += piece;
+
+        const int kept = std::min( offset, 10 );
+        const std::vector<char> copy = ring.copy();
+        QCOMPARE( QByteArray( copy.data(), int(copy.size()) ),
+                  records.mid( (offset - kept) * RECORD_SIZE, kept * RECORD_SIZE ) );
+    }
+}
+
+// the transitions of a whole log, and its tree
+static TransitionLog DecodeLog(const QByteArray& log, AbsBehaviorTree* tree)
+{
+    TransitionLog transitions;
+    FblLayout layout;
+    if( ParseFblLayout( log.constData(), size_t(log.size()), &layout ) != FblError::NONE )
+    {
+        return transitions;
+    }
+    auto res_pair = BuildTreeFromFlatbuffers( Serialization::GetBehaviorTree( log.constData() + 4 ) );
+    TransitionDecoder decoder( res_pair.second, int(res_pair.first.nodesCount()) );
+    decoder.decode( log.constData() + layout.first_record, layout.records_count, transitions );
+    *tree = std::move( res_pair.first );
+    return transitions;
+}
+
+LogReport ReplyTest::analyzeData(const QByteArray &log)
+{
+    QTemporaryFile file;
+    if( !file.open() )
+    {
+        LogReport report;
+        report.error = file.errorString();
+        return report;
+    }
+    file.write( log );
+    file.flush();
+    return AnalyzeLog( file.fileName() );
+}
+
+void ReplyTest::analyzeLog()
+{
+    // the fixture: the tree succeeds
+    const LogReport crossdoor = analyzeData( readFile("://crossdoor_trace.fbl") );
+    QVERIFY2( crossdoor.error.isEmpty(), qPrintable(crossdoor.error) );
+    QCOMPARE( crossdoor.transitions, size_t(27) );
+    QVERIFY( !crossdoor.nodes.empty() );
+    QVERIFY( crossdoor.failure_paths.empty() );
+
+    LogReport report = analyzeData( TestLog() );
+    QVERIFY2( report.error.isEmpty(), qPrintable(report.error) );
+    QCOMPARE( report.transitions, size_t(13) );
+    QVERIFY( std::abs( report.duration - 1.6 ) < 1e-6 );
+    QCOMPARE( report.nodes.size(), size_t(3) );
+    QCOMPARE( report.failure_paths.size(), size_t(2) );
+    QCOMPARE( report.failure_paths.at("Seq > B"), 1 );
+    QCOMPARE( report.failure_paths.at("Seq > A"), 1 );
+    report.filename = "test.fbl";
+
+    // CSV: a header and one row per node
+    QString csv;
+    {
+        QTextStream out( &csv );
+        WriteCsv( out, {report} );
+    }
+    const QStringList lines = csv.split('\n', QString::SkipEmptyParts);
+    QCOMPARE( lines.size(), 4 );
+    QVERIFY( lines[0].startsWith("file,node,model,ticks,success,failure,success_ratio,") );
+    const QStringList row_a = lines[2].split(',');
+    QCOMPARE( row_a.size(), lines[0].split(',').size() );
+    QCOMPARE( row_a.mid(0, 7), QStringList() << "test.fbl" << "A" << "Action" << "2" << "1" << "1" << "0.5" );
+
+    // JSON: the same, and the failure paths
+    const QJsonArray logs = ReportsToJson( {report} ).array();
+    QCOMPARE( logs.size(), 1 );
+    const QJsonObject json = logs[0].toObject();
+    QVERIFY( !json.contains("error") );
+    QCOMPARE( json["transitions"].toInt(), 13 );
+    QCOMPARE( json["nodes"].toArray().size(), 3 );
+    const QJsonObject json_b = json["nodes"].toArray()[2].toObject();
+    QCOMPARE( json_b["name"].toString(), QString("B") );
+    QCOMPARE( json_b["failure"].toInt(), 1 );
+    const QJsonArray failures = json["failure_paths"].toArray();
+    QCOMPARE( failures.size(), 2 );
+    QCOMPARE( failures[0].toObject()["path"].toString(), QString("Seq > A") );
+    QCOMPARE( failures[0].toObject()["count"].toInt(), 1 );
+    QCOMPARE( failures[1].toObject()["path"].toString(), QString("Seq > B") );
+}
+
+void ReplyTest::analyzeLogErrors()
+{
+    const LogReport missing = AnalyzeLog( "/this/file/does/not/exist.fbl" );
+    QVERIFY( !missing.error.isEmpty() );
+    QVERIFY( missing.nodes.empty() );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    const LogReport truncated = analyzeData( log.left(20) );
+    QCOMPARE( truncated.error, QString( toStr(FblError::CORRUPT) ) );
+    QVERIFY( truncated.nodes.empty() );
+
+    // a child that is not in the tree, and a cycle back to the root
+    const LogReport unknown_child = analyzeData( TestLogHeader( {2, 9} ) );
+    QCOMPARE( unknown_child.error, QString( toStr(FblError::CORRUPT) ) );
+    const LogReport cycle = analyzeData( TestLogHeader( {2, 1} ) );
+    QCOMPARE( cycle.error, QString( toStr(FblError::CORRUPT) ) );
+
+    // what precedes an unknown uid is still analyzed
+    log = TestLog();
+    AppendTransition( log, 3.0, 7, Serialization::NodeStatus::IDLE, Serialization::NodeStatus::RUNNING );
+    const LogReport unknown_uid = analyzeData( log );
+    QCOMPARE( unknown_uid.error, QString("unknown node uid in transition 13") );
+    QCOMPARE( unknown_uid.transitions, size_t(13) );
+    QCOMPARE( unknown_uid.failure_paths.size(), size_t(2) );
+}
+
+void ReplyTest::transitionIndex()
+{
+    AbsBehaviorTree tree;
+    const TransitionLog log = DecodeLog( readFile("://crossdoor_trace.fbl"), &tree );
+    QCOMPARE( log.size(), size_t(27) );
+
+    TransitionIndex index;
+    index.reset( tree.nodesCount() );
+    index.append( log, 0 );
+
+    typedef TransitionIndex::Query Query;
+    std::vector<Query> queries( 7 );
+    // [0]: no filter
+    queries[1].min_time = log.timestamp(5);
+    queries[1].max_time = log.timestamp(20);
+    queries[2].any_prev_status = false;
+    queries[2].prev_status = NodeStatus::RUNNING;
+    queries[3].any_status = false;
+    queries[3].status = NodeStatus::FAILURE;
+    queries[4].any_node = false;
+    queries[4].nodes = { log.nodeIndex(3), log.nodeIndex(10), log.nodeIndex(3) };
+    queries[5] = queries[4];
+    queries[5].any_status = false;
+    queries[5].status = NodeStatus::SUCCESS;
+    queries[6] = queries[3];
+    queries[6].min_time = log.timestamp(2);
+
+    for (size_t q = 0; q < queries.size(); q++)
+    {
+        const Query& query = queries[q];
+        std::vector<uint32_t> expected;
+        for (size_t row = 1; row < 25; row++)
+        {
+            const bool node_ok = query.any_node ||
+                    std::count( query.nodes.begin(), query.nodes.end(), log.nodeIndex(row) ) > 0;
+            if( node_ok &&
+                (query.any_prev_status || log.prevStatus(row) == query.prev_status) &&
+                (query.any_status || log.status(row) == query.status) &&
+                log.timestamp(row) >= query.min_time && log.timestamp(row) <= query.max_time )
+            {
+                expected.push_back( uint32_t(row) );
+            }
+        }
+        QVERIFY2( index.find( log, query, 1, 25 ) == expected, qPrintable( QString("query %1").arg(q) ) );
+    }
+}
+
+// Many ticks of TestLogHeader(), much longer than the interval of the checkpoints.
+// Some ticks leave B in its final status: the next one is not a restart.
+static QByteArray LongTestLog(int ticks)
+{
+    using Serialization::NodeStatus;
+    QByteArray log = TestLogHeader();
+    std::map<uint16_t, NodeStatus> status = { {1, NodeStatus::IDLE}, {2, NodeStatus::IDLE}, {3, NodeStatus::IDLE} };
+    double time = 1.0;
+    auto change = [&](uint16_t uid, NodeStatus new_status)
+    {
+        AppendTransition( log, time, uid, status[uid], new_status );
+        status[uid] = new_status;
+        time += 0.01;
+    };
+
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        change( 1, NodeStatus::RUNNING );
+        change( 2, NodeStatus::RUNNING );
+        if( tick % 3 == 0 )
+        {
+            change( 2, NodeStatus::FAILURE );
+            change( 1, NodeStatus::FAILURE );
+        }
+        else{
+            change( 2, NodeStatus::SUCCESS );
+            change( 3, NodeStatus::RUNNING );
+            change( 3, (tick % 5 == 0) ? NodeStatus::FAILURE : NodeStatus::SUCCESS );
+            change( 1, status[3] );
+        }
+        for (uint16_t uid: {2, 3, 1})
+        {
+            if( status[uid] != NodeStatus::IDLE && !(uid == 3 && tick % 7 == 0) )
+            {
+                change( uid, NodeStatus::IDLE );
+            }
+        }
+    }
+    return log;
+}
+
+void ReplyTest::checkpointSeek()
+{
+    const QByteArray data = LongTestLog( 1000 );
+    AbsBehaviorTree tree;
+    const TransitionLog log = DecodeLog( data, &tree );
+    QVERIFY( log.size() > 5000 );
+    QVERIFY( log.restartRows().size() > 500 );
+    const size_t nodes_count = tree.nodesCount();
+
+    // decoded and appended in chunks, like the transitions loaded in the background
+    FblLayout layout;
+    QVERIFY( ParseFblLayout( data.constData(), size_t(data.size()), &layout ) == FblError::NONE );
+    auto res_pair = BuildTreeFromFlatbuffers( Serialization::GetBehaviorTree( data.constData() + 4 ) );
+    TransitionDecoder decoder( res_pair.second, int(nodes_count) );
+    TransitionLog appended;
+    TransitionCheckpoints checkpoints;
+    checkpoints.reset( nodes_count );
+    for (size_t row = 0; row < layout.records_count; row += 777)
+    {
+        const size_t count = std::min<size_t>( 777, layout.records_count - row );
+        TransitionLog chunk;
+        decoder.decode( data.constData() + layout.first_record + row * TransitionDecoder::RECORD_SIZE,
+                        count, chunk );
+        appended.append( chunk );
+        checkpoints.append( appended, row );
+    }
+    QCOMPARE( appended.size(), log.size() );
+    QVERIFY( appended.restartRows() == log.restartRows() );
+
+    // every row, compared with the state replayed from the first one
+    TransitionCheckpoints::TreeState linear( nodes_count, {NodeStatus::IDLE, NodeStatus::IDLE} );
+    for (size_t row = 0; row < appended.size(); row++)
+    {
+        TransitionCheckpoints::applyTransition( appended, linear, row );
+        if( checkpoints.stateAtRow( appended, row ) != linear )
+        {
+            QFAIL( qPrintable( QString("wrong state at row %1").arg(row) ) );
+        }
+    }
+}
+
+void ReplyTest::playbackClock()
+{
+    const double FRAME = 0.016;
+    using Serialization::NodeStatus;
+
+    // 2 seconds of transitions, one per millisecond
+    QByteArray data = TestLogHeader();
+    for (int i = 0; i <= 2000; i++)
+    {
+        const bool running = (i % 2 == 0);
+        AppendTransition( data, 100.0 + i * 0.001, 2,
+                          running ? NodeStatus::IDLE : NodeStatus::RUNNING,
+                          running ? NodeStatus::RUNNING : NodeStatus::IDLE );
+    }
+    AbsBehaviorTree tree;
+    const TransitionLog log = DecodeLog( data, &tree );
+    QCOMPARE( log.size(), size_t(2001) );
+
+    for (double speed: {0.1, 1.0, 10.0, 100.0})
+    {
+        PlaybackClock clock;
+        clock.start( log, 0 );
+        int frames = 0;
+        size_t row = 0;
+        while( row < log.size() - 1 && frames < 100000 )
+        {
+            const size_t previous = row;
+            row = clock.advance( log, FRAME, speed );
+            frames++;
+
+            // each frame shows the last transition due, however many there are since the previous one
+            QCOMPARE( row, std::min( log.upperBound( clock.time() ) - 1, log.size() - 1 ) );
+            QVERIFY( row >= previous );
+            QVERIFY( std::abs( clock.time() - (100.0 + frames * FRAME * speed) ) < 1e-6 );
+        }
+        const int expected_frames = int( std::ceil( 2.0 / (FRAME * speed) ) );
+        QVERIFY2( std::abs( frames - expected_frames ) <= 1,
+                  qPrintable( QString("%1 frames at %2x").arg(frames).arg(speed) ) );
+    }
+
+    // a long pause of the tree is shortened to MAX_IDLE_WAIT of wall time
+    data = TestLogHeader();
+    AppendTransition( data, 100.0, 2, NodeStatus::IDLE, NodeStatus::RUNNING );
+    AppendTransition( data, 101.0, 2, NodeStatus::RUNNING, NodeStatus::SUCCESS );
+    AppendTransition( data, 1000.0, 2, NodeStatus::SUCCESS, NodeStatus::IDLE );
+    const TransitionLog sparse = DecodeLog( data, &tree );
+    QCOMPARE( sparse.size(), size_t(3) );
+
+    for (double speed: {1.0, 10.0})
+    {
+        PlaybackClock clock;
+        clock.start( sparse, 0 );
+        int frames = 0;
+        while( clock.advance( sparse, FRAME, speed ) < 2 && frames < 100000 )
+        {
+            frames++;
+        }
+        const int max_frames = 2 * ( int( std::ceil( PlaybackClock::MAX_IDLE_WAIT / FRAME ) ) + 2 );
+        QVERIFY2( frames <= max_frames, qPrintable( QString("%1 frames at %2x").arg(frames).arg(speed) ) );
+    }
+
+    // started in the middle, the clock never goes back
+    PlaybackClock clock;
+    clock.start( log, 1500 );
+    QCOMPARE( clock.row(), size_t(1500) );
+    QCOMPARE( clock.advance( log, 0, 1.0 ), size_t(1500) );
+}
+
+void ReplyTest::sparseTree()
+{
+    // leaves without children_uid, models without ports, nodes without remaps
+    const QByteArray log = TestLog( TestLogHeader( {2, 3}, true ) );
+
+    AbsBehaviorTree tree;
+    const TransitionLog transitions = DecodeLog( log, &tree );
+    QCOMPARE( transitions.size(), size_t(13) );
+    QCOMPARE( tree.nodesCount(), size_t(4) );
+    QCOMPARE( tree.node(1)->children_index.size(), size_t(2) );
+    QVERIFY( tree.node(2)->children_index.empty() );
+    QVERIFY( tree.node(2)->model.ports.empty() );
+
+    const LogReport report = analyzeData( log );
+    QVERIFY2( report.error.isEmpty(), qPrintable(report.error) );
+    QCOMPARE( report.failure_paths.size(), size_t(2) );
+
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+    sidepanel_replay->loadLog( log );
+    QTRY_VERIFY( !sidepanel_replay->isLoading() );
+    QCOMPARE( sidepanel_replay->transitionsCount(), size_t(13) );
+    main_win->on_actionClear_triggered();
 }
 
 QTEST_MAIN(ReplyTest)